@@ -0,0 +1,60 @@
+// SHA-256 over iterator ranges: absorbing one element per call, as
+// hasher::absorb(begin, end) used to, against absorbing the whole range, which
+// takes contiguous ranges as one span and gathers the rest into block-sized
+// buffers. The pointer overload is the ceiling.
+// Usage: bench_absorb [MiB]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
+#include <digestpp.hpp>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    template<typename Container>
+    void compare(const char* name, const Container& bytes, const std::string& expected) {
+        const double megabytes = static_cast<double>(bytes.size()) / 1e6;
+
+        auto start = Clock::now();
+        digestpp::sha256 one;
+        for (auto it = bytes.begin(); it != bytes.end(); ++it)
+            one.absorb(it, std::next(it));
+        const std::string byteWise = one.hexdigest();
+        const double perByte = seconds(start);
+
+        start = Clock::now();
+        const std::string bulk = digestpp::sha256().absorb(bytes.begin(), bytes.end()).hexdigest();
+        const double ranged = seconds(start);
+
+        std::printf("%-16s %10.0f %10.0f %8.2fx  %s\n", name, megabytes / perByte, megabytes / ranged, perByte / ranged,
+                    byteWise == expected && bulk == expected ? "ok" : "MISMATCH");
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16;
+    std::vector<unsigned char> vector(mib << 20);
+    for (size_t i = 0; i < vector.size(); i++)
+        vector[i] = static_cast<unsigned char>(i * 131 + (i >> 12));
+
+    auto start = Clock::now();
+    const std::string expected = digestpp::sha256().absorb(vector.data(), vector.size()).hexdigest();
+    const double pointer = seconds(start);
+    std::printf("SHA-256 of %zu MiB, MB/s\n", mib);
+    std::printf("%-16s %10s %10s %9s\n", "range", "per byte", "bulk", "speedup");
+    std::printf("%-16s %21.0f\n", "pointer", static_cast<double>(vector.size()) / 1e6 / pointer);
+
+    compare("vector", vector, expected);
+    compare("string", std::string(vector.begin(), vector.end()), expected);
+    compare("deque", std::deque<unsigned char>(vector.begin(), vector.end()), expected);
+    compare("list", std::list<unsigned char>(vector.begin(), vector.end()), expected);
+}
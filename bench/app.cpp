@@ -0,0 +1,269 @@
+// End-to-end load on one App shared by several threads: signups, logins,
+// subscription changes, video publishes and searches, subscription checks and
+// playlist edits, mixed by weight. Channels, searched words and playlists are
+// picked with a Zipfian skew, so a few are hot and most are cold. Reports the
+// throughput and latency of every operation.
+// Usage: bench_app [operations] [threads] [skew, 0 to 0.999] [mix, as name=weight,...]
+// e.g.   bench_app 1000000 8 0.99 search=40,subscribe=5
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <App.h>
+#include <Channel.h>
+#include <LatencyHistogram.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t user_count = 100000;
+    constexpr size_t channel_count = 10000;
+    constexpr size_t video_count = 50000;
+    constexpr size_t word_count = 5000;
+    constexpr size_t music_channel_count = 1000;
+    constexpr size_t song_count = 200;
+
+    // Ranks 0..n-1, rank r drawn with probability proportional to 1 / (r + 1)^theta;
+    // Gray et al.'s method, as in YCSB: O(n) to set up, O(1) per draw.
+    class Zipfian {
+    public:
+        Zipfian(uint64_t items, double theta)
+            : n(items), theta(theta), zetan(zeta(items, theta)), alpha(1 / (1 - theta)),
+              eta((1 - std::pow(2.0 / static_cast<double>(items), 1 - theta)) / (1 - zeta(2, theta) / zetan)) {}
+
+        uint64_t operator()(std::mt19937_64& random) const {
+            const double u = std::uniform_real_distribution<double>(0, 1)(random);
+            const double uz = u * zetan;
+            if (uz < 1)
+                return 0;
+            if (uz < 1 + std::pow(0.5, theta))
+                return 1;
+            const auto rank = static_cast<uint64_t>(static_cast<double>(n) * std::pow(eta * u - eta + 1, alpha));
+            return std::min(rank, n - 1);
+        }
+
+    private:
+        uint64_t n;
+        double theta, zetan, alpha, eta;
+
+        static double zeta(uint64_t items, double theta) {
+            double sum = 0;
+            for (uint64_t i = 1; i <= items; i++)
+                sum += 1 / std::pow(static_cast<double>(i), theta);
+            return sum;
+        }
+    };
+
+    enum Operation : size_t { signup, login, subscribe, unsubscribe, publish, search, check, playlist, operation_count };
+
+    constexpr std::array<std::string_view, operation_count> operation_names{
+        "signup", "login", "subscribe", "unsubscribe", "publish", "search", "check", "playlist"};
+
+    // Reads the mix argument into weights; false on an unknown name or a bad weight.
+    bool parseMix(std::string_view mix, std::array<unsigned, operation_count>& weights) {
+        while (!mix.empty()) {
+            const auto comma = mix.find(',');
+            const std::string_view entry = mix.substr(0, comma);
+            mix = comma == std::string_view::npos ? std::string_view() : mix.substr(comma + 1);
+            const auto equals = entry.find('=');
+            if (equals == std::string_view::npos)
+                return false;
+            size_t op = 0;
+            while (op < operation_count && operation_names[op] != entry.substr(0, equals))
+                ++op;
+            char* end = nullptr;
+            const std::string weight(entry.substr(equals + 1));
+            const unsigned long value = std::strtoul(weight.c_str(), &end, 10);
+            if (op == operation_count || weight.empty() || *end != '\0')
+                return false;
+            weights[op] = static_cast<unsigned>(value);
+        }
+        return true;
+    }
+
+    std::string word(uint64_t rank) {
+        std::string text(1, 'w');
+        text += std::to_string(rank);
+        return text;
+    }
+
+    // Everything the workers share. App takes one lock; each music channel has its own.
+    struct World {
+        App app;
+        std::shared_mutex appLock;
+        std::vector<Channel*> channels;
+        std::vector<User> musicOwners;
+        std::vector<std::unique_ptr<MusicChannel>> music;
+        std::vector<std::mutex> musicLocks;
+        Zipfian channelRank;
+        Zipfian wordRank;
+        Zipfian musicRank;
+
+        World(double skew, const std::vector<User>& users)
+            : app(users), channelRank(channel_count, skew), wordRank(word_count, skew),
+              musicRank(music_channel_count, skew) {}
+    };
+
+    void populate(World& world) {
+        for (size_t i = 0; i < channel_count; i++)
+            world.app.addChannel("channel" + std::to_string(i), world.app.getUser(i * 10));
+        world.channels = world.app.getChannels();
+        std::mt19937_64 random(7);
+        for (size_t i = 0; i < video_count; i++)
+            world.channels[world.channelRank(random)]->publishVideo(word(world.wordRank(random)) + " " +
+                                                                    word(world.wordRank(random)));
+        for (size_t user = 0; user < user_count; user++)
+            for (int k = 0; k < 5; k++)
+                world.app.subscribe("user" + std::to_string(user), world.channelRank(random));
+        world.musicOwners.reserve(music_channel_count);
+        world.music.reserve(music_channel_count);
+        world.musicLocks = std::vector<std::mutex>(music_channel_count);
+        for (size_t i = 0; i < music_channel_count; i++) {
+            world.musicOwners.emplace_back("artist" + std::to_string(i));
+            world.music.push_back(std::make_unique<MusicChannel>("music" + std::to_string(i), &world.musicOwners.back()));
+        }
+    }
+
+    void perform(World& world, Operation op, std::mt19937_64& random, size_t thread, size_t i) {
+        const std::string user = "user" + std::to_string(random() % user_count);
+        switch (op) {
+            case signup: {
+                std::unique_lock lock(world.appLock);
+                world.app.addUser("new" + std::to_string(thread) + "_" + std::to_string(i));
+                break;
+            }
+            case login: {
+                // login counts its attempts, so it writes
+                std::unique_lock lock(world.appLock);
+                (void)world.app.login(user, "password");
+                break;
+            }
+            case subscribe: {
+                std::unique_lock lock(world.appLock);
+                world.app.subscribe(user, world.channelRank(random));
+                break;
+            }
+            case unsubscribe: {
+                std::unique_lock lock(world.appLock);
+                world.app.unsubscribe(user, world.channelRank(random));
+                break;
+            }
+            case publish: {
+                const std::string title = word(world.wordRank(random)) + " " + word(world.wordRank(random));
+                std::unique_lock lock(world.appLock);
+                world.channels[world.channelRank(random)]->publishVideo(title);
+                break;
+            }
+            case search: {
+                const std::string query = word(world.wordRank(random));
+                std::shared_lock lock(world.appLock);
+                (void)world.app.searchVideos(query, 20);
+                break;
+            }
+            case check: {
+                std::shared_lock lock(world.appLock);
+                (void)world.app.getSubscriptions().isSubscribed(static_cast<uint32_t>(random() % user_count),
+                                                                 static_cast<uint32_t>(world.channelRank(random)));
+                break;
+            }
+            case playlist: {
+                const size_t channel = world.musicRank(random);
+                const std::string song = "song" + std::to_string(random() % song_count);
+                std::lock_guard lock(world.musicLocks[channel]);
+                MusicChannel& music = *world.music[channel];
+                const auto kind = random() % 4;
+                if (kind < 2)
+                    music.addToPlaylist(song);
+                else if (kind == 2)
+                    music.moveInPlaylist(song, random() % song_count);
+                else
+                    music.removeFromPlaylist(song);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t threads = argc > 2 ? std::max<size_t>(1, std::strtoull(argv[2], nullptr, 10)) : 4;
+    const double skew = argc > 3 ? std::strtod(argv[3], nullptr) : 0.99;
+    std::array<unsigned, operation_count> weights{2, 3, 15, 10, 5, 20, 35, 10};
+    const bool mixed = argc <= 4 || parseMix(argv[4], weights);
+    const bool idle = std::all_of(weights.begin(), weights.end(), [](unsigned weight) { return weight == 0; });
+    if (!(skew >= 0 && skew < 1) || !mixed || idle) {
+        std::fprintf(stderr, "usage: bench_app [operations] [threads] [skew, 0 to 0.999] [mix, as name=weight,...]\n");
+        return 1;
+    }
+    std::discrete_distribution<size_t> mix(weights.begin(), weights.end());
+    // addUser reports duplicates on std::cerr and App says goodbye on std::cout
+    std::cout.setstate(std::ios::failbit);
+
+    std::vector<User> users;
+    users.reserve(user_count);
+    for (size_t i = 0; i < user_count; i++)
+        users.emplace_back("user" + std::to_string(i));
+    auto world = std::make_unique<World>(skew, users);
+    const auto setup = Clock::now();
+    populate(*world);
+    std::printf("%zu users, %zu channels, %zu videos, %zu music channels; setup %.2f s\n", user_count, channel_count,
+                video_count, music_channel_count, std::chrono::duration<double>(Clock::now() - setup).count());
+    std::printf("%zu operations on %zu threads, skew %.3f\n", operations, threads, skew);
+
+    std::vector<std::array<LatencyHistogram, operation_count>> latencies(threads);
+    const size_t perThread = std::max<size_t>(1, operations / threads);
+    const auto start = Clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < threads; t++)
+            workers.emplace_back([&, t] {
+                std::mt19937_64 random(t + 1);
+                auto pick = mix;
+                for (size_t i = 0; i < perThread; i++) {
+                    const auto op = static_cast<Operation>(pick(random));
+                    const auto begin = Clock::now();
+                    perform(*world, op, random, t, i);
+                    latencies[t][op].record(Clock::now() - begin);
+                }
+            });
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("%-12s %10s %12s %9s %9s %9s %9s %10s\n", "operation", "count", "ops/s", "mean us", "p50 us",
+                "p99 us", "p99.9 us", "max us");
+    LatencyHistogram all;
+    for (size_t op = 0; op < operation_count; op++) {
+        LatencyHistogram total;
+        for (const auto& thread : latencies)
+            total.merge(thread[op]);
+        all.merge(total);
+        if (total.count() == 0)
+            continue;
+        std::printf("%-12s %10llu %12.0f %9.2f %9.2f %9.2f %9.2f %10.1f\n", std::string(operation_names[op]).c_str(),
+                    static_cast<unsigned long long>(total.count()), static_cast<double>(total.count()) / elapsed,
+                    total.mean() / 1e3, static_cast<double>(total.percentile(50)) / 1e3,
+                    static_cast<double>(total.percentile(99)) / 1e3, static_cast<double>(total.percentile(99.9)) / 1e3,
+                    static_cast<double>(total.max()) / 1e3);
+    }
+    std::printf("%-12s %10llu %12.0f %9.2f %9.2f %9.2f %9.2f %10.1f\n", "all",
+                static_cast<unsigned long long>(all.count()), static_cast<double>(all.count()) / elapsed,
+                all.mean() / 1e3, static_cast<double>(all.percentile(50)) / 1e3,
+                static_cast<double>(all.percentile(99)) / 1e3, static_cast<double>(all.percentile(99.9)) / 1e3,
+                static_cast<double>(all.max()) / 1e3);
+    std::fflush(stdout);
+    // skip tearing down the App
+    std::_Exit(0);
+}
@@ -0,0 +1,155 @@
+// Cost of taking a consistent copy of an App while a writer keeps changing it:
+// how long the copy holds the writer up, what the writer's first writes to
+// shared data cost afterwards, and how much memory live copies keep.
+// With fewer cores than threads, a write can be preempted by the reader while
+// it holds the lock, and its time then includes the reader's.
+// Usage: bench_copy [writes per run]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <App.h>
+#include <LatencyHistogram.h>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t user_count = 200000;
+    constexpr size_t channel_count = 20000;
+    constexpr size_t video_count = 100000;
+
+    // Resident set in MiB, or 0 where it is not known.
+    double residentMiB() {
+#if defined(__linux__)
+        if (std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+            unsigned long size = 0, resident = 0;
+            const int read = std::fscanf(f, "%lu %lu", &size, &resident);
+            std::fclose(f);
+            if (read == 2)
+                return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1 << 20);
+        }
+#endif
+        return 0;
+    }
+
+    void populate(App& app, const std::vector<std::string>& names) {
+        for (const auto& name : names)
+            app.addUser(name);
+        for (size_t i = 0; i < channel_count; i++)
+            app.addChannel("channel" + std::to_string(i), app.getUser(i * 10));
+        const auto channels = app.getChannels();
+        std::mt19937_64 random(7);
+        for (size_t i = 0; i < video_count; i++)
+            channels[random() % channel_count]->publishVideo("video " + std::to_string(random() % 5000) + " part " +
+                                                             std::to_string(i % 40));
+        for (const auto& name : names)
+            for (int k = 0; k < 5; k++)
+                app.subscribe(name, random() % channel_count);
+    }
+
+    // One write of the mix: mostly subscription changes, some new videos and accounts.
+    void write(App& app, const std::vector<Channel*>& channels, const std::vector<std::string>& names,
+               std::mt19937_64& random, size_t i) {
+        const auto kind = random() % 100;
+        if (kind < 45)
+            app.subscribe(names[random() % user_count], random() % channel_count);
+        else if (kind < 85)
+            app.unsubscribe(names[random() % user_count], random() % channel_count);
+        else if (kind < 97)
+            channels[random() % channel_count]->publishVideo("video " + std::to_string(random() % 5000) + " new");
+        else
+            app.addUser("late" + std::to_string(i));
+    }
+
+    void printRow(const char* name, const LatencyHistogram& latency) {
+        std::printf("%-22s %9llu %10.2f %10.2f %10.1f\n", name, static_cast<unsigned long long>(latency.count()),
+                    static_cast<double>(latency.percentile(50)) / 1e3, static_cast<double>(latency.percentile(99)) / 1e3,
+                    static_cast<double>(latency.max()) / 1e3);
+    }
+}
+
+int main(int argc, char** argv) {
+    // App's destructor announces itself on std::cout; keep that out of the table
+    std::cout.setstate(std::ios::failbit);
+    const size_t writes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    std::vector<std::string> names;
+    names.reserve(user_count);
+    for (size_t i = 0; i < user_count; i++)
+        names.push_back("user" + std::to_string(i));
+
+    App app;
+    populate(app, names);
+    const auto channels = app.getChannels();
+    std::printf("%zu users, %zu channels, %zu videos; resident %.1f MiB\n", user_count, channel_count, video_count,
+                residentMiB());
+    std::printf("%-22s %9s %10s %10s %10s\n", "", "count", "p50 us", "p99 us", "max us");
+
+    // the writer alone
+    std::mt19937_64 random(11);
+    LatencyHistogram alone;
+    for (size_t i = 0; i < writes; i++) {
+        const auto begin = Clock::now();
+        write(app, channels, names, random, i);
+        alone.record(Clock::now() - begin);
+    }
+    printRow("write, no copies", alone);
+
+    // the writer while a reader copies the App every millisecond and reads the
+    // copy; both are timed inside the lock, leaving out waits for it and the CPU
+    std::mutex lock;
+    std::atomic<bool> done{false};
+    LatencyHistogram shared, copying;
+    size_t reads = 0;
+    std::jthread reader([&] {
+        std::mt19937_64 pick(3);
+        while (!done.load(std::memory_order_relaxed)) {
+            std::unique_ptr<App> copy;
+            {
+                std::lock_guard guard(lock);
+                const auto begin = Clock::now();
+                copy = std::make_unique<App>(app);
+                copying.record(Clock::now() - begin);
+            }
+            for (int k = 0; k < 100; k++)
+                reads += copy->findUser(names[pick() % user_count]).has_value();
+            reads += copy->searchVideos("video " + std::to_string(pick() % 5000)).size();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    for (size_t i = 0; i < writes; i++) {
+        std::lock_guard guard(lock);
+        const auto begin = Clock::now();
+        write(app, channels, names, random, writes + i);
+        shared.record(Clock::now() - begin);
+    }
+    done = true;
+    reader.join();
+    printRow("write, copies taken", shared);
+    printRow("copy", copying);
+
+    // memory held by live copies, each followed by a burst of writes that unshares part of the App
+    const double before = residentMiB();
+    std::vector<App> held;
+    held.reserve(16);
+    for (size_t c = 0; c < 16; c++) {
+        held.push_back(app);
+        for (size_t i = 0; i < 2000; i++)
+            write(app, channels, names, random, 2 * writes + c * 2000 + i);
+    }
+    const double after = residentMiB();
+    std::printf("16 copies, 2000 writes after each: +%.1f MiB resident (%.2f MiB per copy; reads %zu)\n",
+                after - before, (after - before) / 16, reads);
+    std::fflush(stdout);
+    // skip tearing down the copies
+    std::_Exit(0);
+}
@@ -0,0 +1,80 @@
+// One viral channel: 1 to 64 threads subscribe to and unsubscribe from the same
+// row, two subscribes to every unsubscribe, on StripedCounters and on a single
+// std::atomic counter with the same clamp-at-zero decrement. With threads on
+// separate cores the single counter's cache line bounces between them on every
+// update; striping gives each thread a line of its own. Throughput is whole
+// operations per second, over all threads.
+// Usage: bench_counters [operations per thread] [max threads]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <StripedCounters.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // What ChannelTable did before the stripes, made thread-safe.
+    struct SingleCounter {
+        alignas(64) std::atomic<uint64_t> count{0};
+
+        void increment() { count.fetch_add(1, std::memory_order_relaxed); }
+        void decrement() {
+            uint64_t value = count.load(std::memory_order_relaxed);
+            while (value > 0 && !count.compare_exchange_weak(value, value - 1, std::memory_order_relaxed)) {}
+        }
+        [[nodiscard]] uint64_t read() const { return count.load(std::memory_order_relaxed); }
+    };
+
+    struct Striped {
+        StripedCounters counters;
+
+        Striped() { counters.resize(1); }
+        void increment() { counters.increment(0); }
+        void decrement() { counters.decrement(0); }
+        [[nodiscard]] uint64_t read() const { return counters.exact(0); }
+    };
+
+    // Returns millions of operations per second; checks the final count.
+    template<typename Counter>
+    double run(size_t threads, size_t operations, bool& correct) {
+        Counter counter;
+        const auto start = Clock::now();
+        {
+            std::vector<std::jthread> workers;
+            for (size_t t = 0; t < threads; t++)
+                workers.emplace_back([&] {
+                    for (size_t i = 0; i < operations; i++) {
+                        if (i % 3 == 2)
+                            counter.decrement();
+                        else
+                            counter.increment();
+                    }
+                });
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        // every thread's decrements follow two of its own increments, so none clamps
+        const uint64_t expected = threads * (operations - operations / 3 - operations / 3);
+        correct = correct && counter.read() == expected;
+        return static_cast<double>(threads * operations) / elapsed / 1e6;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 3000000;
+    const size_t maxThreads = argc > 2 ? std::max<size_t>(1, std::strtoull(argv[2], nullptr, 10)) : 64;
+    std::printf("%zu operations per thread, %u hardware threads\n", operations, std::thread::hardware_concurrency());
+    std::printf("%8s %16s %16s\n", "threads", "single Mops/s", "striped Mops/s");
+    bool correct = true;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        const double single = run<SingleCounter>(threads, operations, correct);
+        const double striped = run<Striped>(threads, operations, correct);
+        std::printf("%8zu %16.1f %16.1f\n", threads, single, striped);
+    }
+    std::printf("final counts exact: %s\n", correct ? "yes" : "no");
+    return correct ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+// Password hashing throughput: one hash_password call per credential against
+// PasswordManager::hash_passwords, which spreads the batch over worker threads
+// and hashes several messages per SIMD pass on each. The batch is timed at 1,
+// 2, 4 ... workers up to the maximum, so the scaling with cores shows; past the
+// hardware thread count the extra workers only share cores.
+// Usage: bench_hash [credentials] [password length] [max workers]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <PasswordManager.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const size_t length = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 12;
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t maxWorkers = argc > 3 ? std::max<size_t>(1, std::strtoull(argv[3], nullptr, 10)) : hardware;
+
+    std::vector<std::pair<std::string, PasswordManager::Salt>> credentials;
+    credentials.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string password = std::to_string(i);
+        password.resize(length, 'x');
+        credentials.emplace_back(std::move(password), PasswordManager::make_salt());
+    }
+    std::printf("%zu credentials, %zu-byte passwords, %zu hardware threads\n", count, length, hardware);
+
+    std::vector<PasswordManager::Digest> one(count);
+    const auto start = Clock::now();
+    for (size_t i = 0; i < count; i++)
+        one[i] = PasswordManager::hash_password(credentials[i].first, credentials[i].second);
+    const double serial = seconds(start);
+    std::printf("%-24s %10.3f s %12.0f hashes/s\n", "hash_password", serial, static_cast<double>(count) / serial);
+
+    bool match = true;
+    for (size_t workers = 1;; workers = std::min(workers * 2, maxWorkers)) {
+        std::vector<PasswordManager::Digest> batch(count);
+        const auto begin = Clock::now();
+        PasswordManager::hash_passwords(credentials, batch, workers);
+        const double batched = seconds(begin);
+        match = match && one == batch;
+        std::printf("hash_passwords %3zu workers %10.3f s %12.0f hashes/s %6.2fx\n", workers, batched,
+                    static_cast<double>(count) / batched, serial / batched);
+        if (workers == maxWorkers)
+            break;
+    }
+    std::printf("digests match: %s\n", match ? "yes" : "no");
+    return match ? 0 : 1;
+}
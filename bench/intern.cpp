@@ -0,0 +1,160 @@
+// Memory for the names and titles of a catalogue of channels and videos, held
+// as std::string copies the way User and Channel used to hold them, against
+// 32-bit StringInterner symbols: heap allocations, resident memory, and the
+// allocations made by a loop that reads every name back, by value before and
+// as a string_view now. Channel owners repeat the owner's username and video
+// titles repeat across channels, as they do in the app.
+// Usage: bench_intern [channels] [videos per channel]
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <StringInterner.h>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+    std::atomic<size_t> allocations{0};
+
+    // Resident set in bytes, or 0 where it is not known.
+    double residentBytes() {
+#if defined(__linux__)
+        if (std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+            unsigned long size = 0, resident = 0;
+            const int read = std::fscanf(f, "%lu %lu", &size, &resident);
+            std::fclose(f);
+            if (read == 2)
+                return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0;
+    }
+
+    void releaseFreeMemory() {
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+    }
+
+    // Source text, built before anything is measured. Owners are shared by four
+    // channels; titles come from a few thousand, long enough to leave the
+    // small-string buffer, so most repeat across channels.
+    struct Catalogue {
+        size_t channels;
+        size_t videos;
+        std::vector<std::string> names, owners, titles;
+
+        Catalogue(size_t channels, size_t videos) : channels(channels), videos(videos) {
+            for (size_t c = 0; c < channels; c++)
+                names.push_back("channel number " + std::to_string(c));
+            for (size_t c = 0; c < channels; c += 4)
+                owners.push_back("owner" + std::to_string(c / 4));
+            for (size_t t = 0; t < 4096 * 8; t++)
+                titles.push_back("video about topic " + std::to_string(t / 8) + ", part " + std::to_string(t % 8));
+        }
+
+        const std::string& owner(size_t channel) const { return owners[channel / 4]; }
+        const std::string& title(size_t channel, size_t video) const {
+            return titles[(channel * 31 + video * 7) % 4096 * 8 + video % 8];
+        }
+    };
+
+    struct StringChannel {
+        std::string name;
+        std::string owner;
+        std::vector<std::string> titles;
+
+        std::string getName() const { return name; }
+    };
+
+    struct SymbolChannel {
+        StringInterner::Symbol name;
+        StringInterner::Symbol owner;
+        std::vector<StringInterner::Symbol> titles;
+    };
+
+    struct Usage {
+        size_t allocations;
+        double resident;
+        size_t readAllocations;
+    };
+
+    void printRow(const char* name, const Usage& usage, size_t strings) {
+        std::printf("%-12s %12zu %12.1f %12.1f %14zu\n", name, usage.allocations, usage.resident / (1 << 20),
+                    usage.resident / static_cast<double>(strings), usage.readAllocations);
+    }
+}
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    const Catalogue catalogue(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000,
+                              argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20);
+    const size_t strings = catalogue.channels * (catalogue.videos + 2);
+    std::printf("%zu channels, %zu videos each, %zu strings\n", catalogue.channels, catalogue.videos, strings);
+    std::printf("%-12s %12s %12s %12s %14s\n", "", "allocations", "RSS MiB", "B/string", "read allocs");
+
+    size_t characters = 0;
+    {
+        releaseFreeMemory();
+        const double before = residentBytes();
+        const size_t allocated = allocations;
+        std::vector<StringChannel> channels(catalogue.channels);
+        for (size_t c = 0; c < catalogue.channels; c++) {
+            channels[c].name = catalogue.names[c];
+            channels[c].owner = catalogue.owner(c);
+            channels[c].titles.reserve(catalogue.videos);
+            for (size_t v = 0; v < catalogue.videos; v++)
+                channels[c].titles.push_back(catalogue.title(c, v));
+        }
+        Usage usage{allocations - allocated, residentBytes() - before, 0};
+        const size_t reading = allocations;
+        for (const auto& channel : channels)
+            characters += channel.getName().size();
+        usage.readAllocations = allocations - reading;
+        printRow("std::string", usage, strings);
+    }
+
+    {
+        releaseFreeMemory();
+        const double before = residentBytes();
+        const size_t allocated = allocations;
+        StringInterner interner;
+        std::vector<SymbolChannel> channels(catalogue.channels);
+        for (size_t c = 0; c < catalogue.channels; c++) {
+            channels[c].name = interner.intern(catalogue.names[c]);
+            channels[c].owner = interner.intern(catalogue.owner(c));
+            channels[c].titles.reserve(catalogue.videos);
+            for (size_t v = 0; v < catalogue.videos; v++)
+                channels[c].titles.push_back(interner.intern(catalogue.title(c, v)));
+        }
+        Usage usage{allocations - allocated, residentBytes() - before, 0};
+        const size_t reading = allocations;
+        for (const auto& channel : channels)
+            characters += interner.view(channel.name).size();
+        usage.readAllocations = allocations - reading;
+        printRow("interned", usage, strings);
+        std::printf("%zu distinct strings, %zu arena bytes (%zu characters read)\n", interner.size(), interner.bytes(),
+                    characters);
+    }
+}
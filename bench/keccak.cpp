@@ -0,0 +1,77 @@
+// The batched Keccak-p[1600] engine against the one-state permutation, and
+// KangarooTwelve end to end against hashing its leaves one sponge at a time,
+// as K12 did before leaves went through the engine.
+// Usage: bench_keccak [MiB of K12 input]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <digestpp.hpp>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    namespace sha3 = digestpp::detail::sha3_functions;
+
+    constexpr size_t leaf_size = 8192;
+
+    double seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    // Nanoseconds per state per permutation, for L states permuted together.
+    template<int R, size_t L>
+    double permutation(size_t rounds) {
+        std::vector<uint64_t> A(25 * L, 1);
+        const auto start = Clock::now();
+        for (size_t i = 0; i < rounds; i++) {
+            if constexpr (L == 1)
+                sha3::transform<R>(A.data());
+            else
+                sha3::transform_multi<R, L>(A.data());
+        }
+        const double elapsed = seconds(start);
+        if (A[0] == 42)
+            std::printf(" ");
+        return elapsed * 1e9 / static_cast<double>(rounds * L);
+    }
+
+    template<int R>
+    void permutations() {
+        const size_t rounds = 2000000 / (R / 12);
+        std::printf("%2d rounds: scalar %7.1f  x4 %7.1f  x8 %7.1f ns per state\n", R, permutation<R, 1>(rounds),
+                    permutation<R, 4>(rounds / 4), permutation<R, 8>(rounds / 8));
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const auto lanes = sha3::multi_lanes();
+    std::printf("widest kernel: %zu states (x4 and x8 fall back to the scalar loop without AVX2 / AVX-512F)\n", lanes);
+    permutations<12>();
+    permutations<24>();
+
+    std::string data(mib << 20, '\0');
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<char>(i * 131 + (i >> 13));
+
+    // the leaves alone, one SHAKE-style sponge each, as before batching
+    auto start = Clock::now();
+    std::vector<unsigned char> cv(32 * (data.size() / leaf_size));
+    digestpp::detail::shake_provider<128, 12> leaf;
+    for (size_t i = 0; i < data.size() / leaf_size; i++) {
+        leaf.init();
+        leaf.set_suffix(0x0b);
+        leaf.update(reinterpret_cast<const unsigned char*>(data.data()) + i * leaf_size, leaf_size);
+        leaf.squeeze(cv.data() + i * 32, 32);
+    }
+    const double scalar = seconds(start);
+
+    start = Clock::now();
+    const std::string digest = digestpp::k12().absorb(data).hexsqueeze(32);
+    const double batched = seconds(start);
+
+    const double megabytes = static_cast<double>(data.size()) / 1e6;
+    std::printf("K12 over %zu MiB: scalar leaves %.0f MB/s, k12() %.0f MB/s, %.2fx (%.16s...)\n", mib,
+                megabytes / scalar, megabytes / batched, scalar / batched, digest.c_str());
+}
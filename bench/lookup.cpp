@@ -0,0 +1,81 @@
+// Finding a user by name: UserIndex against a walk over std::vector<User*>,
+// which was the only way to do it before the index. Half the lookups hit and
+// half miss; each one is timed on its own, so the figures include one clock
+// read, shown on the first line.
+// Usage: bench_lookup [largest user count]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <LatencyHistogram.h>
+#include <User.h>
+#include <UserIndex.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // name of user i, or of a user that does not exist when i is past the end
+    std::string nameOf(size_t i) {
+        return "user" + std::to_string(i);
+    }
+
+    void printRow(const char* name, size_t users, const LatencyHistogram& latency) {
+        std::printf("%-8s %10zu %9llu %10.0f %10llu %10llu\n", name, users,
+                    static_cast<unsigned long long>(latency.count()), latency.mean(),
+                    static_cast<unsigned long long>(latency.percentile(50)),
+                    static_cast<unsigned long long>(latency.percentile(99)));
+    }
+
+    template<typename Find>
+    LatencyHistogram measure(size_t users, size_t lookups, Find find) {
+        std::mt19937_64 random(users);
+        std::vector<std::string> queries(lookups);
+        for (size_t i = 0; i < lookups; i++)
+            queries[i] = nameOf(random() % (2 * users));
+        LatencyHistogram latency;
+        size_t found = 0;
+        for (const auto& query : queries) {
+            const auto begin = Clock::now();
+            found += find(query);
+            latency.record(Clock::now() - begin);
+        }
+        if (found > lookups)
+            std::printf("?");
+        return latency;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t largest = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    LatencyHistogram clock;
+    for (int i = 0; i < 100000; i++) {
+        const auto begin = Clock::now();
+        clock.record(Clock::now() - begin);
+    }
+    std::printf("clock read: p50 %llu ns\n", static_cast<unsigned long long>(clock.percentile(50)));
+    std::printf("%-8s %10s %9s %10s %10s %10s\n", "lookup", "users", "lookups", "mean ns", "p50 ns", "p99 ns");
+
+    std::vector<std::unique_ptr<User>> owned;
+    std::vector<User*> users;
+    UserIndex index;
+    for (size_t n = 1000; n <= largest; n *= 10) {
+        while (users.size() < n) {
+            owned.push_back(std::make_unique<User>(nameOf(users.size())));
+            users.push_back(owned.back().get());
+            index.insert(users.back()->getUsername(), static_cast<uint32_t>(users.size() - 1));
+        }
+        printRow("index", n, measure(n, 1000000, [&](const std::string& name) {
+            return index.find(name) != UserIndex::npos;
+        }));
+        // a scan costs O(n), so it gets fewer lookups as n grows
+        printRow("linear", n, measure(n, std::max<size_t>(200, 100000000 / n), [&](const std::string& name) {
+            return std::find_if(users.begin(), users.end(),
+                                [&](const User* user) { return user->getUsername() == name; }) != users.end();
+        }));
+    }
+}
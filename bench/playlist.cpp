@@ -0,0 +1,122 @@
+// Playlist against the std::vector<std::string> MusicChannel used to keep its
+// playlist in: memory per entry, then the latency of membership checks,
+// inserts at random positions, removals, moves and position lookups, each
+// operation timed on its own. A churn of removals and re-inserts at random
+// places then leaves chunks partly filled, and memory is reported again.
+// Usage: bench_playlist [largest entry count]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <LatencyHistogram.h>
+#include <Playlist.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using SongId = Playlist::SongId;
+
+    constexpr size_t operations = 20000;
+
+    std::string titleOf(SongId id) {
+        return "song title number " + std::to_string(id);
+    }
+
+    // Heap bytes of the strings, as allocated: their buffers are past the small-string size.
+    size_t vectorBytes(const std::vector<std::string>& list) {
+        size_t bytes = list.capacity() * sizeof(std::string);
+        for (const auto& title : list)
+            bytes += title.capacity() + 1;
+        return bytes;
+    }
+
+    void printRow(const char* name, size_t entries, const LatencyHistogram& latency) {
+        std::printf("%-10s %-12s %8zu %10.0f %10llu %10llu\n", "", name, entries, latency.mean(),
+                    static_cast<unsigned long long>(latency.percentile(50)),
+                    static_cast<unsigned long long>(latency.percentile(99)));
+    }
+
+    template<typename F>
+    LatencyHistogram time(size_t count, F f) {
+        LatencyHistogram latency;
+        for (size_t i = 0; i < count; i++) {
+            const auto begin = Clock::now();
+            f(i);
+            latency.record(Clock::now() - begin);
+        }
+        return latency;
+    }
+
+    void run(size_t entries) {
+        std::mt19937_64 random(entries);
+        // ids [0, entries) start on the playlist; [entries, 2 * entries) are spare songs
+        Playlist playlist;
+        std::vector<std::string> list;
+        for (SongId id = 0; id < entries; id++) {
+            playlist.push_back(id);
+            list.push_back(titleOf(id));
+        }
+        std::printf("%zu entries: %.1f B/entry (std::vector<std::string> %.1f B/entry)\n", entries,
+                    static_cast<double>(playlist.memoryUsage()) / static_cast<double>(entries),
+                    static_cast<double>(vectorBytes(list)) / static_cast<double>(entries));
+        std::printf("%-10s %-12s %8s %10s %10s %10s\n", "ns", "operation", "count", "mean", "p50", "p99");
+
+        // probes: half on the playlist, half not
+        std::vector<SongId> probes(operations);
+        for (auto& probe : probes)
+            probe = static_cast<SongId>(random() % (2 * entries));
+        size_t found = 0;
+        printRow("contains", operations, time(operations, [&](size_t i) { found += playlist.contains(probes[i]); }));
+        const size_t linear = std::max<size_t>(1, operations / 100);
+        std::vector<std::string> titles(linear);
+        for (size_t i = 0; i < linear; i++)
+            titles[i] = titleOf(probes[i]);
+        printRow("linear find", linear, time(linear, [&](size_t i) {
+            found += std::find(list.begin(), list.end(), titles[i]) != list.end();
+        }));
+
+        std::vector<SongId> spare(operations);
+        for (size_t i = 0; i < operations; i++)
+            spare[i] = static_cast<SongId>(entries + i % entries);
+        std::sort(spare.begin(), spare.end());
+        spare.erase(std::unique(spare.begin(), spare.end()), spare.end());
+        std::shuffle(spare.begin(), spare.end(), random);
+        std::vector<size_t> positions(operations);
+        for (auto& position : positions)
+            position = random() % entries;
+        printRow("insert", spare.size(), time(spare.size(), [&](size_t i) {
+            found += playlist.insert(positions[i], spare[i]);
+        }));
+        printRow("position", operations, time(operations, [&](size_t i) {
+            found += playlist.position(static_cast<SongId>(positions[i])) != Playlist::npos;
+        }));
+        printRow("move", operations, time(operations, [&](size_t i) {
+            found += playlist.move(static_cast<SongId>(positions[i]), positions[(i + 1) % operations]);
+        }));
+        printRow("erase", spare.size(), time(spare.size(), [&](size_t i) { found += playlist.erase(spare[i]); }));
+        printRow("vector erase", linear, time(linear, [&](size_t i) {
+            list.erase(list.begin() + static_cast<std::ptrdiff_t>(positions[i] % list.size()));
+        }));
+
+        // churn: removals and re-inserts at random places leave chunks partly filled
+        for (size_t i = 0; i < entries; i++) {
+            const auto id = static_cast<SongId>(random() % entries);
+            if (!playlist.erase(id))
+                playlist.insert(random() % (playlist.size() + 1), id);
+        }
+        std::printf("after churn: %zu entries, %.1f B/entry (checksum %zu)\n\n", playlist.size(),
+                    static_cast<double>(playlist.memoryUsage()) / static_cast<double>(playlist.size()), found);
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t largest = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t entries = std::min<size_t>(10000, std::max<size_t>(largest, 1));
+    for (;; entries = std::min(entries * 10, largest)) {
+        run(entries);
+        if (entries >= largest)
+            break;
+    }
+}
@@ -0,0 +1,98 @@
+// Allocating users one by one with new and freeing them with delete, as App
+// did before, against ObjectPool<User>: allocation rate, resident memory per
+// user while they are live, and teardown time. Names are interned up front so
+// both sides pay for the same work.
+// Usage: bench_pool [users]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ObjectPool.h>
+#include <StringInterner.h>
+#include <User.h>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    // Resident set in bytes, or 0 where it is not known.
+    double residentBytes() {
+#if defined(__linux__)
+        if (std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+            unsigned long size = 0, resident = 0;
+            const int read = std::fscanf(f, "%lu %lu", &size, &resident);
+            std::fclose(f);
+            if (read == 2)
+                return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0;
+    }
+
+    // Hands freed heap pages back to the system, so the next run starts from the same footing.
+    void releaseFreeMemory() {
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+    }
+
+    void printRow(const char* name, size_t users, double allocation, double resident, double teardown) {
+        std::printf("%-12s %12.1f %12.1f %12.1f\n", name, static_cast<double>(users) / allocation / 1e6,
+                    resident / static_cast<double>(users), teardown * 1e3);
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::vector<std::string> names(count);
+    StringInterner::global().reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        names[i] = "user" + std::to_string(i);
+        (void)StringInterner::global().intern(names[i]);
+    }
+    std::printf("%zu users, sizeof(User) %zu\n", count, sizeof(User));
+    std::printf("%-12s %12s %12s %12s\n", "", "M allocs/s", "RSS B/user", "teardown ms");
+
+    {
+        std::vector<User*> users;
+        users.reserve(count);
+        releaseFreeMemory();
+        const double before = residentBytes();
+        const auto start = Clock::now();
+        for (const auto& name : names)
+            users.push_back(new User(name));
+        const double allocation = seconds(start);
+        const double resident = residentBytes() - before;
+        const auto teardown = Clock::now();
+        for (User* user : users)
+            delete user;
+        printRow("new/delete", count, allocation, resident, seconds(teardown));
+    }
+
+    {
+        std::vector<ObjectPool<User>::Handle> users;
+        users.reserve(count);
+        releaseFreeMemory();
+        const double before = residentBytes();
+        auto pool = std::make_unique<ObjectPool<User>>();
+        const auto start = Clock::now();
+        for (const auto& name : names)
+            users.push_back(pool->create(name));
+        const double allocation = seconds(start);
+        const double resident = residentBytes() - before;
+        const auto teardown = Clock::now();
+        pool.reset();
+        printRow("ObjectPool", count, allocation, resident, seconds(teardown));
+    }
+}
@@ -0,0 +1,148 @@
+// TitleIndex at scale: builds an index over synthetic titles of five words
+// drawn from a Zipfian vocabulary, then times searches of several shapes and
+// prefix completions one by one and reports their latency percentiles. Common
+// words are the ones with long posting lists; a page of results (limit 100)
+// stops the cursors early, an unlimited search walks the lists to the end.
+// Usage: bench_search [titles] [vocabulary] [queries per shape]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <LatencyHistogram.h>
+#include <TitleIndex.h>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t words_per_title = 5;
+    constexpr size_t page = 100;
+
+    double seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    // Resident set in bytes, or 0 where it is not known.
+    double residentBytes() {
+#if defined(__linux__)
+        if (std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+            unsigned long size = 0, resident = 0;
+            const int read = std::fscanf(f, "%lu %lu", &size, &resident);
+            std::fclose(f);
+            if (read == 2)
+                return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0;
+    }
+
+    // Distinct lower-case words, shortest for the most frequent ranks.
+    std::vector<std::string> makeVocabulary(size_t count) {
+        std::vector<std::string> words(count);
+        for (size_t rank = 0; rank < count; rank++) {
+            size_t n = rank + 26;
+            while (n > 0) {
+                words[rank] += static_cast<char>('a' + n % 26);
+                n /= 26;
+            }
+        }
+        return words;
+    }
+
+    // Ranks drawn with probability proportional to 1 / (rank + 1).
+    class Zipf {
+    public:
+        explicit Zipf(size_t count) : cumulative(count) {
+            double sum = 0;
+            for (size_t rank = 0; rank < count; rank++)
+                cumulative[rank] = sum += 1.0 / static_cast<double>(rank + 1);
+        }
+
+        size_t operator()(std::mt19937_64& random) const {
+            const double u = std::uniform_real_distribution<double>(0, cumulative.back())(random);
+            return static_cast<size_t>(std::lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin());
+        }
+
+    private:
+        std::vector<double> cumulative;
+    };
+
+    void printRow(const char* name, const LatencyHistogram& latency, size_t hits) {
+        std::printf("%-32s %8.1f %8.1f %8.1f %9.1f %10.1f\n", name, static_cast<double>(latency.percentile(50)) / 1e3,
+                    static_cast<double>(latency.percentile(90)) / 1e3, static_cast<double>(latency.percentile(99)) / 1e3,
+                    static_cast<double>(latency.max()) / 1e3,
+                    static_cast<double>(hits) / static_cast<double>(std::max<uint64_t>(1, latency.count())));
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t titles = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t vocabularySize = argc > 2 ? std::max<size_t>(2000, std::strtoull(argv[2], nullptr, 10)) : 200000;
+    const size_t queries = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2000;
+
+    const std::vector<std::string> vocabulary = makeVocabulary(vocabularySize);
+    const Zipf zipf(vocabularySize);
+    std::mt19937_64 random(17);
+
+    TitleIndex index;
+    const double before = residentBytes();
+    const auto start = Clock::now();
+    std::string title;
+    for (size_t t = 0; t < titles; t++) {
+        title.clear();
+        for (size_t w = 0; w < words_per_title; w++) {
+            if (w)
+                title += ' ';
+            title += vocabulary[zipf(random)];
+        }
+        index.add(title);
+    }
+    const double build = seconds(start);
+    std::printf("%zu titles, %zu-word vocabulary (%zu indexed): %.2fM titles/s, %.0f bytes/title resident\n", titles,
+                vocabularySize, index.words(), static_cast<double>(titles) / build / 1e6,
+                (residentBytes() - before) / static_cast<double>(titles));
+    std::printf("%-32s %8s %8s %8s %9s %10s\n", "latency in us", "p50", "p90", "p99", "max", "hits/query");
+
+    // words by frequency rank: [first, last)
+    auto word = [&](size_t first, size_t last) -> const std::string& {
+        return vocabulary[first + random() % (last - first)];
+    };
+    auto measure = [&](const char* name, size_t count, size_t limit, auto makeQuery) {
+        LatencyHistogram latency;
+        size_t hits = 0;
+        for (size_t q = 0; q < count; q++) {
+            const std::string query = makeQuery();
+            const auto begin = Clock::now();
+            hits += index.search(query, limit).size();
+            latency.record(Clock::now() - begin);
+        }
+        printRow(name, latency, hits);
+    };
+
+    measure("top-10 word, first 100", queries, page, [&] { return word(0, 10); });
+    measure("two top-10 words, first 100", queries, page, [&] { return word(0, 10) + ' ' + word(0, 10); });
+    measure("rank 1k-10k + top-10, first 100", queries, page, [&] { return word(1000, 10000) + ' ' + word(0, 10); });
+    measure("rank 100-1k + rank 100-1k, all", queries, SIZE_MAX, [&] { return word(100, 1000) + ' ' + word(100, 1000); });
+    measure("three rank 100-1k words, all", queries, SIZE_MAX,
+            [&] { return word(100, 1000) + ' ' + word(100, 1000) + ' ' + word(100, 1000); });
+    measure("two top-10 words, all", std::max<size_t>(1, queries / 10), SIZE_MAX,
+            [&] { return word(0, 10) + ' ' + word(0, 10); });
+    measure("missing word + top-10", queries, page, [&] { return "zzzzzzzz " + word(0, 10); });
+
+    LatencyHistogram completion;
+    size_t suggestions = 0;
+    for (size_t q = 0; q < queries; q++) {
+        const std::string& source = vocabulary[zipf(random)];
+        const std::string prefix = source.substr(0, 1 + random() % std::min<size_t>(3, source.size()));
+        const auto begin = Clock::now();
+        suggestions += index.complete(prefix).size();
+        completion.record(Clock::now() - begin);
+    }
+    printRow("complete 1-3 letter prefix", completion, suggestions);
+}
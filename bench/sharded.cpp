@@ -0,0 +1,102 @@
+// Throughput of a read-mostly workload on ShardedApp with 1 to 64 threads, for
+// a single shard (one lock for everything) and for many.
+// Usage: bench_sharded [operations per run] [shards]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <LatencyHistogram.h>
+#include <ShardedApp.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t user_count = 200000;
+    constexpr size_t channel_count = 20000;
+
+    std::vector<std::string> makeNames() {
+        std::vector<std::string> names;
+        names.reserve(user_count);
+        for (size_t i = 0; i < user_count; i++)
+            names.push_back("user" + std::to_string(i));
+        return names;
+    }
+
+    std::vector<ShardedApp::ChannelId> populate(ShardedApp& app, const std::vector<std::string>& names) {
+        const PasswordManager::Digest digest{};
+        const PasswordManager::Salt salt{};
+        for (const auto& name : names)
+            app.addUser(name, digest, salt);
+        std::vector<ShardedApp::ChannelId> channels;
+        channels.reserve(channel_count);
+        for (size_t i = 0; i < channel_count; i++)
+            channels.push_back(app.addChannel("channel" + std::to_string(i), names[i * 10]));
+        std::mt19937_64 random(7);
+        for (const auto& name : names)
+            for (int k = 0; k < 5; k++)
+                app.subscribe(name, channels[random() % channel_count]);
+        return channels;
+    }
+
+    // 80% reads (subscription checks, counts, name lookups), 20% subscription changes
+    void run(ShardedApp& app, const std::vector<std::string>& names, const std::vector<ShardedApp::ChannelId>& channels,
+             size_t threads, size_t operations) {
+        const size_t perThread = std::max<size_t>(1, operations / threads);
+        std::vector<LatencyHistogram> latencies(threads);
+        const auto start = Clock::now();
+        {
+            std::vector<std::jthread> workers;
+            for (size_t t = 0; t < threads; t++)
+                workers.emplace_back([&, t] {
+                    std::mt19937_64 random(t + 1);
+                    uint64_t sink = 0;
+                    for (size_t i = 0; i < perThread; i++) {
+                        const std::string& user = names[random() % user_count];
+                        const ShardedApp::ChannelId channel = channels[random() % channel_count];
+                        const auto kind = random() % 100;
+                        const auto begin = Clock::now();
+                        if (kind < 50)
+                            sink += app.isSubscribed(user, channel);
+                        else if (kind < 70)
+                            sink += app.subscribers(channel);
+                        else if (kind < 80)
+                            sink += app.findUser(user);
+                        else if (kind < 95)
+                            sink += app.subscribe(user, channel);
+                        else
+                            sink += app.unsubscribe(user, channel);
+                        latencies[t].record(Clock::now() - begin);
+                    }
+                    if (sink == 1)
+                        std::printf(" ");
+                });
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        LatencyHistogram total;
+        for (const auto& histogram : latencies)
+            total.merge(histogram);
+        std::printf("%7zu %7zu %12.0f %10.2f %10.2f %10.1f\n", app.shardCount(), threads,
+                    static_cast<double>(total.count()) / elapsed, static_cast<double>(total.percentile(50)) / 1e3,
+                    static_cast<double>(total.percentile(99)) / 1e3, static_cast<double>(total.max()) / 1e3);
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t manyShards = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    const auto names = makeNames();
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    std::printf("%7s %7s %12s %10s %10s %10s\n", "shards", "threads", "ops/s", "p50 us", "p99 us", "max us");
+    for (size_t shardCount : {size_t{1}, manyShards}) {
+        ShardedApp app(shardCount);
+        const auto channels = populate(app, names);
+        for (size_t threads : {1, 2, 4, 8, 16, 32, 64})
+            run(app, names, channels, threads, operations);
+    }
+    std::fflush(stdout);
+    // skip tearing down the shards
+    std::_Exit(0);
+}
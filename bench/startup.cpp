@@ -0,0 +1,100 @@
+// Startup time from a snapshot versus rebuilding the same state operation by
+// operation. Usage: bench_startup [users] [snapshot path]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <App.h>
+#include <Snapshot.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    std::vector<User> makeUsers(size_t count, std::mt19937_64& random) {
+        std::vector<User> users;
+        users.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            PasswordManager::Digest digest;
+            PasswordManager::Salt salt;
+            for (auto& byte : digest)
+                byte = static_cast<uint8_t>(random());
+            for (auto& byte : salt)
+                byte = static_cast<uint8_t>(random());
+            users.emplace_back(digest, "user" + std::to_string(i), salt);
+        }
+        return users;
+    }
+
+    // one channel per 10 users with 4 videos each, 5 subscriptions per user
+    void populate(App& app, size_t userCount, std::mt19937_64& random) {
+        const size_t channelCount = std::max<size_t>(1, userCount / 10);
+        for (size_t i = 0; i < channelCount; i++)
+            app.addChannel("channel" + std::to_string(i), app.getUser(i * 10 % userCount));
+        const auto channels = app.getChannels();
+        for (size_t i = 0; i < channelCount; i++)
+            for (int video = 0; video < 4; video++)
+                channels[i]->publishVideo("episode " + std::to_string(video) + " topic " + std::to_string(random() % 5000));
+        for (size_t i = 0; i < userCount; i++) {
+            const std::string name = "user" + std::to_string(i);
+            for (int k = 0; k < 5; k++)
+                app.subscribe(name, random() % channelCount);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t userCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::filesystem::path path = argc > 2 ? argv[2] : std::filesystem::temp_directory_path() / "bench_startup.snapshot";
+
+    std::mt19937_64 random(42);
+    auto start = Clock::now();
+    App original(makeUsers(userCount, random));
+    populate(original, userCount, random);
+    std::printf("users %zu, channels %zu\n", userCount, original.getChannelTable().size());
+    std::printf("rebuild by operations  %8.2f s\n", seconds(start));
+
+    start = Clock::now();
+    original.saveSnapshot(path);
+    std::printf("save snapshot          %8.2f s  (%.1f MiB)\n", seconds(start),
+                static_cast<double>(std::filesystem::file_size(path)) / (1 << 20));
+
+    start = Clock::now();
+    auto snapshot = std::make_shared<const Snapshot>(path);
+    const double mapped = seconds(start);
+    snapshot->verify();
+    const double verified = seconds(start);
+    const App restored(std::move(snapshot));
+    const double loaded = seconds(start);
+    std::printf("map                    %8.3f s\n", mapped);
+    std::printf("verify checksums       %8.2f s\n", verified - mapped);
+    std::printf("load into App          %8.2f s\n", loaded - verified);
+    std::printf("startup total          %8.2f s\n", loaded);
+
+    // the first reads after startup go to the mapping, with nothing left to build
+    constexpr size_t lookups = 100000;
+    start = Clock::now();
+    size_t found = 0;
+    for (size_t i = 0; i < lookups; i++)
+        found += restored.findUser("user" + std::to_string(random() % userCount)).has_value();
+    std::printf("first lookups          %8.2f us each (%zu found)\n", seconds(start) / lookups * 1e6, found);
+
+    original.refreshChannelStats();
+    const std::string probe = "user" + std::to_string(userCount / 2);
+    const bool same = restored.findUser(probe) && original.findUser(probe) &&
+                      restored.getChannelTable().totalSubscribers() == original.getChannelTable().totalSubscribers() &&
+                      restored.getSubscriptions().edgeCount() == original.getSubscriptions().edgeCount();
+    std::printf("restored state matches: %s\n", same ? "yes" : "no");
+
+    std::filesystem::remove(path);
+    std::fflush(stdout);
+    // skip tearing down millions of objects
+    std::_Exit(same ? 0 : 1);
+}
@@ -0,0 +1,139 @@
+// Commit throughput and latency of App mutations through the write-ahead log,
+// with 1 to 64 threads sharing one App behind a mutex, then the time to replay
+// the log into a fresh App.
+// Usage: bench_wal [commits per run] [log path]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <App.h>
+#include <LatencyHistogram.h>
+#include <WriteAheadLog.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t user_count = 100000;
+    constexpr size_t channel_count = 10000;
+
+    double seconds(Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    std::vector<User> makeUsers() {
+        std::vector<User> users;
+        users.reserve(user_count);
+        for (size_t i = 0; i < user_count; i++)
+            users.emplace_back("user" + std::to_string(i));
+        return users;
+    }
+
+    // The state every run starts from; it is not logged, so recovery rebuilds it the same way.
+    void populate(App& app) {
+        for (size_t i = 0; i < channel_count; i++)
+            app.addChannel("channel" + std::to_string(i), app.getUser(i * 10));
+    }
+
+    std::string exported(const App& app) {
+        std::ostringstream out;
+        app.exportChannels(out);
+        return out.str();
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t commits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    const std::filesystem::path path = argc > 2 ? argv[2] : std::filesystem::temp_directory_path() / "bench_wal.log";
+    std::filesystem::remove(path);
+
+    App app(makeUsers());
+    populate(app);
+    const auto channels = app.getChannels();
+    std::mutex appMutex;
+    auto log = std::make_unique<WriteAheadLog>(path);
+    app.attachLog(*log);
+
+    std::printf("%7s %12s %12s %12s %10s %10s %10s\n", "threads", "commits/s", "fsyncs/s", "per fsync",
+                "p50 us", "p99 us", "max us");
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        const size_t perThread = std::max<size_t>(1, commits / threads);
+        std::vector<LatencyHistogram> latencies(threads);
+        const uint64_t fsyncsBefore = log->stats().fsyncs;
+        const auto start = Clock::now();
+        {
+            std::vector<std::jthread> workers;
+            for (size_t t = 0; t < threads; t++)
+                workers.emplace_back([&, t] {
+                    std::mt19937_64 random(threads * 1000 + t);
+                    for (size_t i = 0; i < perThread; i++) {
+                        const auto begin = Clock::now();
+                        WriteAheadLog::Sequence sequence;
+                        {
+                            const std::lock_guard lock(appMutex);
+                            const std::string user = "user" + std::to_string(random() % user_count);
+                            const size_t channel = random() % channel_count;
+                            const auto kind = random() % 10;
+                            if (kind < 7)
+                                app.subscribe(user, channel);
+                            else if (kind < 9)
+                                app.unsubscribe(user, channel);
+                            else
+                                channels[channel]->publishVideo("clip " + std::to_string(random() % 1000));
+                            sequence = app.loggedThrough();
+                        }
+                        // outside the lock, so other threads' records join this flush
+                        log->sync(sequence);
+                        latencies[t].record(Clock::now() - begin);
+                    }
+                });
+        }
+        const double elapsed = seconds(start);
+        LatencyHistogram total;
+        for (const auto& histogram : latencies)
+            total.merge(histogram);
+        const auto fsyncs = static_cast<double>(log->stats().fsyncs - fsyncsBefore);
+        const auto done = static_cast<double>(total.count());
+        std::printf("%7zu %12.0f %12.0f %12.1f %10.1f %10.1f %10.1f\n", threads, done / elapsed, fsyncs / elapsed,
+                    done / fsyncs, static_cast<double>(total.percentile(50)) / 1e3,
+                    static_cast<double>(total.percentile(99)) / 1e3, static_cast<double>(total.max()) / 1e3);
+    }
+    std::printf("\n");
+    {
+        std::ostringstream stats;
+        stats << log->stats();
+        std::printf("%s", stats.str().c_str());
+    }
+
+    app.refreshChannelStats();
+    const std::string expected = exported(app);
+    const size_t expectedEdges = app.getSubscriptions().edgeCount();
+    app.detachLog();
+    log.reset();
+
+    auto start = Clock::now();
+    App recovered(makeUsers());
+    populate(recovered);
+    const double rebuilt = seconds(start);
+    start = Clock::now();
+    WriteAheadLog reopened(path);
+    recovered.attachLog(reopened);
+    const double replayed = seconds(start);
+    recovered.refreshChannelStats();
+    const bool same = exported(recovered) == expected && recovered.getSubscriptions().edgeCount() == expectedEdges;
+    std::printf("replay %llu records   %8.3f s  (base state %.3f s)\n",
+                static_cast<unsigned long long>(recovered.loggedThrough()), replayed, rebuilt);
+    std::printf("recovered state matches: %s\n", same ? "yes" : "no");
+
+    recovered.detachLog();
+    std::filesystem::remove(path);
+    std::fflush(stdout);
+    // skip tearing down the Apps
+    std::_Exit(same ? 0 : 1);
+}
@@ -7,6 +7,7 @@ This code is written by kerukuro and released into public domain.
 
 #include "../hasher.hpp"
 #include "detail/blake2_provider.hpp"
+#include "detail/blake2b_multi.hpp"
 #include "mixin/blake2_mixin.hpp"
 
 /// digestpp namespace
@@ -191,6 +192,40 @@ typedef hasher<detail::blake2_provider<uint64_t, detail::blake2_type::xof>, mixi
  */
 typedef hasher<detail::blake2_provider<uint32_t, detail::blake2_type::xof>, mixin::blake2_mixin> blake2xs_xof;
 
+/**
+ * @brief Computes BLAKE2b digests of many independent messages at once
+ *
+ * Messages are hashed in lockstep, one per SIMD lane: 8 lanes with AVX-512, 4 lanes with AVX2,
+ * otherwise one at a time. The lane count is picked at runtime and does not affect the output,
+ * which is identical to hashing each message with \ref blake2b.
+ *
+ * @param[in] hashsize Output digest size (in bits), 8 - 512
+ * @param[in] data Array of count message pointers
+ * @param[in] len Array of count message lengths (in bytes)
+ * @param[in] salt Array of count pointers to 16-byte salts; the array or any entry may be nullptr for no salt
+ * @param[out] out Buffer of count * hashsize / 8 bytes; digest i is written at out + i * hashsize / 8
+ * @param[in] count Number of messages
+ *
+ * @throw std::runtime_error if the requested digest size is not divisible by 8 (full bytes),
+ * or is not within the supported range
+ *
+ * @par Example:\n
+ * @code // Hash two strings with a single call
+ * std::string a = "The quick brown fox", b = "jumps over the lazy dog";
+ * const unsigned char* data[] = { reinterpret_cast<const unsigned char*>(a.data()), reinterpret_cast<const unsigned char*>(b.data()) };
+ * size_t len[] = { a.size(), b.size() };
+ * unsigned char out[2 * 64];
+ * digestpp::blake2b_multi(512, data, len, nullptr, out, 2);
+ * @endcode
+ *
+ * @sa blake2b
+ */
+inline void blake2b_multi(size_t hashsize, const unsigned char* const* data, const size_t* len,
+		const unsigned char* const* salt, unsigned char* out, size_t count)
+{
+	detail::blake2b_multi(hashsize, data, len, salt, out, count);
+}
+
 } // namespace digestpp
 
 #endif // DIGESTPP_ALGORITHM_BLAKE2_HPP
\ No newline at end of file
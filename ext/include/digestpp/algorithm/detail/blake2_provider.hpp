@@ -9,6 +9,7 @@ This code is written by kerukuro and released into public domain.
 #include "../../detail/absorb_data.hpp"
 #include "../../detail/validate_hash_size.hpp"
 #include "constants/blake2_constants.hpp"
+#include "blake2_simd.hpp"
 #include <array>
 #include <limits>
 
@@ -267,11 +268,11 @@ private:
 
 	inline void transform(const unsigned char* data, size_t num_blks, bool padding)
 	{
+#ifdef DIGESTPP_HAS_X86_SIMD
+		const bool simd = blake2_simd_functions::available<T>();
+#endif
 		for (size_t blk = 0; blk < num_blks; blk++)
 		{
-			T M[16];
-			for (int i = 0; i < 16; i++)
-				M[i] = reinterpret_cast<const T*>(data)[blk * 16 + i];
 			uint64_t totalbytes = total / 8 + (padding ? 0 : (blk + 1) * N) / 4;
 			T t0 = static_cast<T>(totalbytes);
 			T t1 = N == 512 ? 0 : static_cast<T>(totalbytes >> 32);
@@ -282,6 +283,17 @@ private:
 				f0 = static_cast<T>(-1);
 				f1 = 0;
 			}
+#ifdef DIGESTPP_HAS_X86_SIMD
+			if (simd)
+			{
+				blake2_simd_functions::compress(H.data(), data + blk * N / 4, t0, t1, f0);
+				continue;
+			}
+#endif
+
+			T M[16];
+			for (int i = 0; i < 16; i++)
+				M[i] = reinterpret_cast<const T*>(data)[blk * 16 + i];
 
 			T v[16];
 			memcpy(v, H.data(), sizeof(T) * 8);
@@ -0,0 +1,191 @@
+/*
+This code is written by kerukuro and released into public domain.
+*/
+
+#ifndef DIGESTPP_PROVIDERS_BLAKE2_SIMD_HPP
+#define DIGESTPP_PROVIDERS_BLAKE2_SIMD_HPP
+
+#include "../../detail/cpu_features.hpp"
+#include "constants/blake2_constants.hpp"
+#include <cstring>
+
+namespace digestpp
+{
+
+namespace detail
+{
+
+// Single-stream BLAKE2 compression with the 4x4 state held as four row vectors.
+// The first half of a round works on columns; rotating rows b, c and d turns the diagonals
+// into columns for the second half, and the inverse rotation restores the layout.
+namespace blake2_simd_functions
+{
+#ifdef DIGESTPP_HAS_X86_SIMD
+	DIGESTPP_TARGET("avx2") inline __m256i ror32_avx2(__m256i x)
+	{
+		return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+	}
+
+	DIGESTPP_TARGET("avx2") inline __m256i ror24_avx2(__m256i x)
+	{
+		const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+				3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+		return _mm256_shuffle_epi8(x, r24);
+	}
+
+	DIGESTPP_TARGET("avx2") inline __m256i ror16_avx2(__m256i x)
+	{
+		const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+				2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+		return _mm256_shuffle_epi8(x, r16);
+	}
+
+	DIGESTPP_TARGET("avx2") inline __m256i ror63_avx2(__m256i x)
+	{
+		return _mm256_or_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x));
+	}
+
+	DIGESTPP_TARGET("avx2") inline void G_avx2(__m256i& a, __m256i& b, __m256i& c, __m256i& d, __m256i x, __m256i y)
+	{
+		a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);
+		d = ror32_avx2(_mm256_xor_si256(d, a));
+		c = _mm256_add_epi64(c, d);
+		b = ror24_avx2(_mm256_xor_si256(b, c));
+		a = _mm256_add_epi64(_mm256_add_epi64(a, b), y);
+		d = ror16_avx2(_mm256_xor_si256(d, a));
+		c = _mm256_add_epi64(c, d);
+		b = ror63_avx2(_mm256_xor_si256(b, c));
+	}
+
+	// BLAKE2b: each row of four 64-bit words fills one AVX2 register.
+	DIGESTPP_TARGET("avx2") inline void compress(uint64_t* H, const unsigned char* block, uint64_t t0, uint64_t t1, uint64_t f0)
+	{
+		uint64_t M[16];
+		memcpy(M, block, sizeof(M));
+
+		const __m256i h0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(H));
+		const __m256i h1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(H + 4));
+		__m256i a = h0;
+		__m256i b = h1;
+		__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blake2b_constants<void>::IV));
+		__m256i d = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(blake2b_constants<void>::IV + 4)),
+				_mm256_set_epi64x(0, static_cast<long long>(f0), static_cast<long long>(t1), static_cast<long long>(t0)));
+
+		for (int r = 0; r < 12; r++)
+		{
+			const uint32_t* S = blake2_constants<void>::S[r];
+			__m256i x = _mm256_set_epi64x(static_cast<long long>(M[S[6]]), static_cast<long long>(M[S[4]]),
+					static_cast<long long>(M[S[2]]), static_cast<long long>(M[S[0]]));
+			__m256i y = _mm256_set_epi64x(static_cast<long long>(M[S[7]]), static_cast<long long>(M[S[5]]),
+					static_cast<long long>(M[S[3]]), static_cast<long long>(M[S[1]]));
+			G_avx2(a, b, c, d, x, y);
+
+			b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+			c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+			d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));
+
+			x = _mm256_set_epi64x(static_cast<long long>(M[S[14]]), static_cast<long long>(M[S[12]]),
+					static_cast<long long>(M[S[10]]), static_cast<long long>(M[S[8]]));
+			y = _mm256_set_epi64x(static_cast<long long>(M[S[15]]), static_cast<long long>(M[S[13]]),
+					static_cast<long long>(M[S[11]]), static_cast<long long>(M[S[9]]));
+			G_avx2(a, b, c, d, x, y);
+
+			b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));
+			c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+			d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(H), _mm256_xor_si256(h0, _mm256_xor_si256(a, c)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(H + 4), _mm256_xor_si256(h1, _mm256_xor_si256(b, d)));
+	}
+
+	DIGESTPP_TARGET("sse4.1") inline __m128i ror16_sse(__m128i x)
+	{
+		const __m128i r16 = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+		return _mm_shuffle_epi8(x, r16);
+	}
+
+	DIGESTPP_TARGET("sse4.1") inline __m128i ror8_sse(__m128i x)
+	{
+		const __m128i r8 = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+		return _mm_shuffle_epi8(x, r8);
+	}
+
+	template<int n>
+	DIGESTPP_TARGET("sse4.1") inline __m128i ror_sse(__m128i x)
+	{
+		return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - n));
+	}
+
+	DIGESTPP_TARGET("sse4.1") inline void G_sse(__m128i& a, __m128i& b, __m128i& c, __m128i& d, __m128i x, __m128i y)
+	{
+		a = _mm_add_epi32(_mm_add_epi32(a, b), x);
+		d = ror16_sse(_mm_xor_si128(d, a));
+		c = _mm_add_epi32(c, d);
+		b = ror_sse<12>(_mm_xor_si128(b, c));
+		a = _mm_add_epi32(_mm_add_epi32(a, b), y);
+		d = ror8_sse(_mm_xor_si128(d, a));
+		c = _mm_add_epi32(c, d);
+		b = ror_sse<7>(_mm_xor_si128(b, c));
+	}
+
+	// BLAKE2s: each row of four 32-bit words fills one SSE register.
+	DIGESTPP_TARGET("sse4.1") inline void compress(uint32_t* H, const unsigned char* block, uint32_t t0, uint32_t t1, uint32_t f0)
+	{
+		uint32_t M[16];
+		memcpy(M, block, sizeof(M));
+
+		const __m128i h0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(H));
+		const __m128i h1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(H + 4));
+		__m128i a = h0;
+		__m128i b = h1;
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blake2s_constants<void>::IV));
+		__m128i d = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blake2s_constants<void>::IV + 4)),
+				_mm_set_epi32(0, static_cast<int>(f0), static_cast<int>(t1), static_cast<int>(t0)));
+
+		for (int r = 0; r < 10; r++)
+		{
+			const uint32_t* S = blake2_constants<void>::S[r];
+			__m128i x = _mm_set_epi32(static_cast<int>(M[S[6]]), static_cast<int>(M[S[4]]),
+					static_cast<int>(M[S[2]]), static_cast<int>(M[S[0]]));
+			__m128i y = _mm_set_epi32(static_cast<int>(M[S[7]]), static_cast<int>(M[S[5]]),
+					static_cast<int>(M[S[3]]), static_cast<int>(M[S[1]]));
+			G_sse(a, b, c, d, x, y);
+
+			b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+			c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+			d = _mm_shuffle_epi32(d, _MM_SHUFFLE(2, 1, 0, 3));
+
+			x = _mm_set_epi32(static_cast<int>(M[S[14]]), static_cast<int>(M[S[12]]),
+					static_cast<int>(M[S[10]]), static_cast<int>(M[S[8]]));
+			y = _mm_set_epi32(static_cast<int>(M[S[15]]), static_cast<int>(M[S[13]]),
+					static_cast<int>(M[S[11]]), static_cast<int>(M[S[9]]));
+			G_sse(a, b, c, d, x, y);
+
+			b = _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3));
+			c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+			d = _mm_shuffle_epi32(d, _MM_SHUFFLE(0, 3, 2, 1));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(H), _mm_xor_si128(h0, _mm_xor_si128(a, c)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(H + 4), _mm_xor_si128(h1, _mm_xor_si128(b, d)));
+	}
+#endif
+
+	// Whether the running CPU has the extension the row-wise compression for word type T needs.
+	template<typename T>
+	inline bool available()
+	{
+#ifdef DIGESTPP_HAS_X86_SIMD
+		return sizeof(T) == 8 ? cpu().avx2 : cpu().sse41;
+#else
+		return false;
+#endif
+	}
+}
+
+} // namespace detail
+
+} // namespace digestpp
+
+#endif // DIGESTPP_PROVIDERS_BLAKE2_SIMD_HPP
@@ -0,0 +1,271 @@
+/*
+This code is written by kerukuro and released into public domain.
+*/
+
+#ifndef DIGESTPP_PROVIDERS_BLAKE2B_MULTI_HPP
+#define DIGESTPP_PROVIDERS_BLAKE2B_MULTI_HPP
+
+#include "../../detail/functions.hpp"
+#include "../../detail/cpu_features.hpp"
+#include "../../detail/validate_hash_size.hpp"
+#include "blake2_provider.hpp"
+#include "blake2_simd.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace digestpp
+{
+
+namespace detail
+{
+
+// Multi-buffer BLAKE2b: every lane of a vector register carries a different message.
+// State is kept word-major, h[word][lane], so that loading one word for all lanes is a single load.
+namespace blake2b_multi_functions
+{
+	const size_t block_size = 128;
+
+	// Per-lane inputs of one compression step. Lanes with active == 0 keep their chaining value.
+	template<size_t L>
+	struct step
+	{
+		const unsigned char* block[L];
+		uint64_t t[L];
+		uint64_t f[L];
+		uint64_t active[L];
+	};
+
+	template<size_t L>
+	inline void compress_scalar(uint64_t (&h)[8][L], const step<L>& in)
+	{
+		for (size_t l = 0; l < L; l++)
+		{
+			if (!in.active[l])
+				continue;
+
+			uint64_t M[16];
+			memcpy(M, in.block[l], sizeof(M));
+			uint64_t v[16];
+			for (int i = 0; i < 8; i++)
+			{
+				v[i] = h[i][l];
+				v[i + 8] = blake2b_constants<void>::IV[i];
+			}
+			v[12] ^= in.t[l];
+			v[14] ^= in.f[l];
+			for (int r = 0; r < 12; r++)
+				blake2_functions::round(r, M, v);
+			for (int i = 0; i < 8; i++)
+				h[i][l] ^= v[i] ^ v[i + 8];
+		}
+	}
+
+#ifdef DIGESTPP_HAS_X86_SIMD
+	using blake2_simd_functions::G_avx2;
+
+	// Four lanes per step; the message words of the four blocks are transposed into 16 vectors.
+	DIGESTPP_TARGET("avx2") inline void compress_avx2(uint64_t (&h)[8][4], const step<4>& in)
+	{
+		// blocks point into caller data at any alignment, so their words are copied out
+		uint64_t b[4][16];
+		for (int l = 0; l < 4; l++)
+			memcpy(b[l], in.block[l], sizeof(b[l]));
+		__m256i M[16];
+		for (int i = 0; i < 16; i++)
+			M[i] = _mm256_set_epi64x(static_cast<long long>(b[3][i]), static_cast<long long>(b[2][i]),
+					static_cast<long long>(b[1][i]), static_cast<long long>(b[0][i]));
+
+		__m256i v[16];
+		for (int i = 0; i < 8; i++)
+		{
+			v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h[i]));
+			v[i + 8] = _mm256_set1_epi64x(static_cast<long long>(blake2b_constants<void>::IV[i]));
+		}
+		v[12] = _mm256_xor_si256(v[12], _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.t)));
+		v[14] = _mm256_xor_si256(v[14], _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.f)));
+
+		for (int r = 0; r < 12; r++)
+		{
+			const uint32_t* S = blake2_constants<void>::S[r];
+			G_avx2(v[0], v[4], v[8], v[12], M[S[0]], M[S[1]]);
+			G_avx2(v[1], v[5], v[9], v[13], M[S[2]], M[S[3]]);
+			G_avx2(v[2], v[6], v[10], v[14], M[S[4]], M[S[5]]);
+			G_avx2(v[3], v[7], v[11], v[15], M[S[6]], M[S[7]]);
+			G_avx2(v[0], v[5], v[10], v[15], M[S[8]], M[S[9]]);
+			G_avx2(v[1], v[6], v[11], v[12], M[S[10]], M[S[11]]);
+			G_avx2(v[2], v[7], v[8], v[13], M[S[12]], M[S[13]]);
+			G_avx2(v[3], v[4], v[9], v[14], M[S[14]], M[S[15]]);
+		}
+
+		const __m256i active = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.active));
+		for (int i = 0; i < 8; i++)
+		{
+			__m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h[i]));
+			__m256i upd = _mm256_xor_si256(old, _mm256_xor_si256(v[i], v[i + 8]));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(h[i]), _mm256_blendv_epi8(old, upd, active));
+		}
+	}
+
+	// Full-mask form of _mm512_ror_epi64, which avoids the undefined source operand of the plain intrinsic.
+	template<int n>
+	DIGESTPP_TARGET("avx512f") inline __m512i ror_avx512(__m512i x)
+	{
+		return _mm512_mask_ror_epi64(x, 0xff, x, n);
+	}
+
+	DIGESTPP_TARGET("avx512f") inline void G_avx512(__m512i& a, __m512i& b, __m512i& c, __m512i& d, __m512i x, __m512i y)
+	{
+		a = _mm512_add_epi64(_mm512_add_epi64(a, b), x);
+		d = ror_avx512<32>(_mm512_xor_si512(d, a));
+		c = _mm512_add_epi64(c, d);
+		b = ror_avx512<24>(_mm512_xor_si512(b, c));
+		a = _mm512_add_epi64(_mm512_add_epi64(a, b), y);
+		d = ror_avx512<16>(_mm512_xor_si512(d, a));
+		c = _mm512_add_epi64(c, d);
+		b = ror_avx512<63>(_mm512_xor_si512(b, c));
+	}
+
+	// Eight lanes per step, with native 64-bit rotates and masked stores for inactive lanes.
+	DIGESTPP_TARGET("avx512f") inline void compress_avx512(uint64_t (&h)[8][8], const step<8>& in)
+	{
+		__m512i M[16];
+		for (int i = 0; i < 16; i++)
+		{
+			alignas(64) uint64_t w[8];
+			for (int l = 0; l < 8; l++)
+				memcpy(&w[l], in.block[l] + i * 8, 8);
+			M[i] = _mm512_load_si512(w);
+		}
+
+		__m512i v[16];
+		for (int i = 0; i < 8; i++)
+		{
+			v[i] = _mm512_loadu_si512(h[i]);
+			v[i + 8] = _mm512_set1_epi64(static_cast<long long>(blake2b_constants<void>::IV[i]));
+		}
+		v[12] = _mm512_xor_si512(v[12], _mm512_loadu_si512(in.t));
+		v[14] = _mm512_xor_si512(v[14], _mm512_loadu_si512(in.f));
+
+		for (int r = 0; r < 12; r++)
+		{
+			const uint32_t* S = blake2_constants<void>::S[r];
+			G_avx512(v[0], v[4], v[8], v[12], M[S[0]], M[S[1]]);
+			G_avx512(v[1], v[5], v[9], v[13], M[S[2]], M[S[3]]);
+			G_avx512(v[2], v[6], v[10], v[14], M[S[4]], M[S[5]]);
+			G_avx512(v[3], v[7], v[11], v[15], M[S[6]], M[S[7]]);
+			G_avx512(v[0], v[5], v[10], v[15], M[S[8]], M[S[9]]);
+			G_avx512(v[1], v[6], v[11], v[12], M[S[10]], M[S[11]]);
+			G_avx512(v[2], v[7], v[8], v[13], M[S[12]], M[S[13]]);
+			G_avx512(v[3], v[4], v[9], v[14], M[S[14]], M[S[15]]);
+		}
+
+		const __mmask8 active = _mm512_test_epi64_mask(_mm512_loadu_si512(in.active), _mm512_loadu_si512(in.active));
+		for (int i = 0; i < 8; i++)
+		{
+			__m512i old = _mm512_loadu_si512(h[i]);
+			__m512i upd = _mm512_xor_si512(old, _mm512_xor_si512(v[i], v[i + 8]));
+			_mm512_mask_storeu_epi64(h[i], active, upd);
+		}
+	}
+#endif
+
+	// Hash messages L at a time. Each lane advances through its own blocks; a lane whose message
+	// is exhausted stays inactive until the longest message of the group is done.
+	template<size_t L, typename Compress>
+	inline void hash_lanes(size_t hashsize, const unsigned char* const* data, const size_t* len,
+			const unsigned char* const* salt, unsigned char* out, size_t count, Compress compress)
+	{
+		const size_t outlen = hashsize / 8;
+		unsigned char last[L][block_size];
+		const unsigned char zero[block_size] = {};
+
+		for (size_t first = 0; first < count; first += L)
+		{
+			const size_t lanes = std::min(L, count - first);
+			uint64_t h[8][L];
+			size_t blocks[L];
+			size_t max_blocks = 0;
+			for (size_t l = 0; l < L; l++)
+			{
+				for (int i = 0; i < 8; i++)
+					h[i][l] = blake2b_constants<void>::IV[i];
+				h[0][l] ^= 0x0000000001010000ULL ^ outlen;
+				blocks[l] = 0;
+				if (l >= lanes)
+					continue;
+
+				const size_t n = len[first + l];
+				if (salt && salt[first + l])
+				{
+					uint64_t s[2];
+					memcpy(s, salt[first + l], sizeof(s));
+					h[4][l] ^= s[0];
+					h[5][l] ^= s[1];
+				}
+				blocks[l] = n ? (n + block_size - 1) / block_size : 1;
+				max_blocks = std::max(max_blocks, blocks[l]);
+
+				const size_t tail = n - (blocks[l] - 1) * block_size;
+				memset(last[l], 0, block_size);
+				if (tail)
+					memcpy(last[l], data[first + l] + (blocks[l] - 1) * block_size, tail);
+			}
+
+			step<L> in;
+			for (size_t b = 0; b < max_blocks; b++)
+			{
+				for (size_t l = 0; l < L; l++)
+				{
+					const bool is_last = b + 1 == blocks[l];
+					in.active[l] = b < blocks[l] ? ~0ULL : 0;
+					in.f[l] = is_last ? ~0ULL : 0;
+					if (!in.active[l])
+					{
+						in.block[l] = zero;
+						in.t[l] = 0;
+					}
+					else if (is_last)
+					{
+						in.block[l] = last[l];
+						in.t[l] = len[first + l];
+					}
+					else
+					{
+						in.block[l] = data[first + l] + b * block_size;
+						in.t[l] = (b + 1) * block_size;
+					}
+				}
+				compress(h, in);
+			}
+
+			for (size_t l = 0; l < lanes; l++)
+			{
+				uint64_t digest[8];
+				for (int i = 0; i < 8; i++)
+					digest[i] = h[i][l];
+				memcpy(out + (first + l) * outlen, digest, outlen);
+			}
+		}
+	}
+}
+
+// Hash count independent messages with BLAKE2b, choosing the widest lane count the CPU supports.
+inline void blake2b_multi(size_t hashsize, const unsigned char* const* data, const size_t* len,
+		const unsigned char* const* salt, unsigned char* out, size_t count)
+{
+	validate_hash_size(hashsize, 512);
+	using namespace blake2b_multi_functions;
+#ifdef DIGESTPP_HAS_X86_SIMD
+	if (cpu().avx512f && count > 4)
+		return hash_lanes<8>(hashsize, data, len, salt, out, count, compress_avx512);
+	if (cpu().avx2 && count > 1)
+		return hash_lanes<4>(hashsize, data, len, salt, out, count, compress_avx2);
+#endif
+	hash_lanes<1>(hashsize, data, len, salt, out, count, compress_scalar<1>);
+}
+
+} // namespace detail
+
+} // namespace digestpp
+
+#endif // DIGESTPP_PROVIDERS_BLAKE2B_MULTI_HPP
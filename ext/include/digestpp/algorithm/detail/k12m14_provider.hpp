@@ -8,7 +8,12 @@ This code is written by kerukuro and released into public domain.
 #include "../../detail/functions.hpp"
 #include "../../detail/absorb_data.hpp"
 #include "shake_provider.hpp"
+#include "keccak_multi.hpp"
 #include <array>
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 namespace digestpp
 {
@@ -37,6 +42,11 @@ public:
 		S = customization;
 	}
 
+	inline void set_threads(size_t n)
+	{
+		threads = n ? n : std::max(1u, std::thread::hardware_concurrency());
+	}
+
 	inline void init()
 	{
 		main.init();
@@ -88,28 +98,24 @@ public:
 	{
 		(void)reallen;
 
-		for (uint64_t blk = 0; blk < num_blks; blk++)
+		if (num_blks && !chunk)
 		{
-			if (!chunk)
-			{
-				main.update(data, 8192);
-				main.update(reinterpret_cast<const unsigned char*>("\x03\x00\x00\x00\x00\x00\x00\x00"), 8);
-			}
-			else
-			{
-				child.update(data, 8192);
-				unsigned char buf[B / 4];
-				child.squeeze(buf, B / 4);
-				main.update(buf, B / 4);
-			}
-
+			main.update(data, 8192);
+			main.update(reinterpret_cast<const unsigned char*>("\x03\x00\x00\x00\x00\x00\x00\x00"), 8);
 			child.init();
 			child.set_suffix(0x0b);
 			++chunk;
 			data += 8192;
+			--num_blks;
 		}
-	}
 
+		// leaves are independent of each other, only their chaining values must reach main in order
+		if (num_blks)
+		{
+			transform_leaves(data, num_blks);
+			chunk += num_blks;
+		}
+	}
 
 	inline void clear()
 	{
@@ -121,14 +127,101 @@ public:
 	}
 
 private:
+	// Hash L leaves in lockstep, one Keccak state per SIMD lane. A leaf is the 8192-byte chunk
+	// followed by the 0x0b suffix, and its chaining value fits in the first block of output.
+	template<size_t L>
+	static inline void hash_leaves_multi(const unsigned char* data, unsigned char* cv)
+	{
+		constexpr size_t rate = 1600 - B * 2;
+		constexpr size_t r = rate / 8;
+		constexpr size_t full = 8192 / r;
+		constexpr size_t tail = 8192 - full * r;
+
+		uint64_t A[25 * L] = {};
+		const unsigned char* in[L];
+		unsigned char last[L][r];
+		const unsigned char* fin[L];
+		for (size_t l = 0; l < L; l++)
+		{
+			in[l] = data + l * 8192;
+			memcpy(last[l], in[l] + full * r, tail);
+			memset(last[l] + tail, 0, r - tail);
+			last[l][tail] = 0x0b;
+			last[l][r - 1] |= 0x80;
+			fin[l] = last[l];
+		}
+		sha3_functions::transform_multi<R, L>(in, full, A, rate);
+		sha3_functions::transform_multi<R, L>(fin, 1, A, rate);
+
+		for (size_t l = 0; l < L; l++)
+			for (size_t i = 0; i < B / 32; i++)
+				memcpy(cv + l * (B / 4) + i * 8, &A[i * L + l], 8);
+	}
+
+	static inline void hash_leaves(const unsigned char* data, size_t leaves, unsigned char* cv)
+	{
+		size_t done = 0;
+		const size_t lanes = sha3_functions::multi_lanes();
+		if (lanes == 8)
+			for (; done + 8 <= leaves; done += 8)
+				hash_leaves_multi<8>(data + done * 8192, cv + done * (B / 4));
+		for (; lanes >= 4 && done + 4 <= leaves; done += 4)
+			hash_leaves_multi<4>(data + done * 8192, cv + done * (B / 4));
+
+		shake_provider<B, R> leaf;
+		for (; done < leaves; done++)
+		{
+			leaf.init();
+			leaf.set_suffix(0x0b);
+			leaf.update(data + done * 8192, 8192);
+			leaf.squeeze(cv + done * (B / 4), B / 4);
+		}
+	}
+
+	// Hash leaves on up to `threads` threads, one contiguous range each, in rounds of bounded size
+	// so that the buffer of chaining values stays small for multi-gigabyte inputs.
+	inline void transform_leaves(const unsigned char* data, uint64_t num_blks)
+	{
+		const size_t leaves_per_round = threads * 64;
+		cv.resize(static_cast<size_t>(std::min<uint64_t>(num_blks, leaves_per_round)) * (B / 4));
+		while (num_blks)
+		{
+			const size_t leaves = static_cast<size_t>(std::min<uint64_t>(num_blks, leaves_per_round));
+			const size_t per_thread = (leaves + threads - 1) / threads;
+			{
+				// jthreads join on every exit; if the system refuses another thread, the
+				// ranges not yet handed out are hashed on this one
+				std::vector<std::jthread> workers;
+				workers.reserve(threads - 1);
+				size_t first = per_thread;
+				try
+				{
+					for (; first < leaves; first += per_thread)
+						workers.emplace_back(hash_leaves, data + first * 8192, std::min(per_thread, leaves - first), &cv[first * (B / 4)]);
+				}
+				catch (const std::system_error&)
+				{
+				}
+				hash_leaves(data, std::min(per_thread, leaves), cv.data());
+				if (first < leaves)
+					hash_leaves(data + first * 8192, leaves - first, &cv[first * (B / 4)]);
+			}
+			main.update(cv.data(), leaves * (B / 4));
+			data += leaves * 8192;
+			num_blks -= leaves;
+		}
+	}
+
 	constexpr static size_t R = B == 128 ? 12 : 14;
 	shake_provider<B, R> main;
 	shake_provider<B, R> child;
 	std::array<unsigned char, 8192> m;
 	std::string S;
+	std::vector<unsigned char> cv;
 	size_t pos;
 	size_t total;
 	size_t chunk;
+	size_t threads = 1;
 	bool squeezing;
 };
 
@@ -0,0 +1,280 @@
+/*
+This code is written by kerukuro and released into public domain.
+*/
+
+#ifndef DIGESTPP_PROVIDERS_KECCAK_MULTI_HPP
+#define DIGESTPP_PROVIDERS_KECCAK_MULTI_HPP
+
+#include "../../detail/functions.hpp"
+#include "../../detail/cpu_features.hpp"
+#include "sha3_provider.hpp"
+#include <cstring>
+
+namespace digestpp
+{
+
+namespace detail
+{
+
+// Keccak-p[1600] on L independent states in lockstep, shared by SHA-3, SHAKE, cSHAKE, KMAC and K12.
+// States are lane-interleaved: A[i * L + l] is word i of state l, so word i of every state is one vector.
+namespace sha3_functions
+{
+	template<int R, size_t L>
+	inline void transform_multi_scalar(uint64_t* A)
+	{
+		for (size_t l = 0; l < L; l++)
+		{
+			uint64_t S[25];
+			for (int i = 0; i < 25; i++)
+				S[i] = A[i * L + l];
+			transform<R>(S);
+			for (int i = 0; i < 25; i++)
+				A[i * L + l] = S[i];
+		}
+	}
+
+#ifdef DIGESTPP_HAS_X86_SIMD
+	template<int n>
+	DIGESTPP_TARGET("avx2") inline __m256i rol_avx2(__m256i x)
+	{
+		return _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - n));
+	}
+
+	template<int n>
+	DIGESTPP_TARGET("avx512f") inline __m512i rol_avx512(__m512i x)
+	{
+		return _mm512_mask_rol_epi64(x, 0xff, x, n);
+	}
+
+	template<int R>
+	DIGESTPP_TARGET("avx2") inline void transform_x4_avx2(uint64_t* A)
+	{
+		__m256i S[25];
+		for (int i = 0; i < 25; i++)
+			S[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(A + i * 4));
+
+		for (int round = 24 - R; round < 24; round++)
+		{
+			const __m256i C0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(S[0], S[5]), _mm256_xor_si256(S[10], S[15])), S[20]);
+			const __m256i C1 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(S[1], S[6]), _mm256_xor_si256(S[11], S[16])), S[21]);
+			const __m256i C2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(S[2], S[7]), _mm256_xor_si256(S[12], S[17])), S[22]);
+			const __m256i C3 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(S[3], S[8]), _mm256_xor_si256(S[13], S[18])), S[23]);
+			const __m256i C4 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(S[4], S[9]), _mm256_xor_si256(S[14], S[19])), S[24]);
+
+			const __m256i D0 = _mm256_xor_si256(C4, rol_avx2<1>(C1));
+			const __m256i D1 = _mm256_xor_si256(C0, rol_avx2<1>(C2));
+			const __m256i D2 = _mm256_xor_si256(C1, rol_avx2<1>(C3));
+			const __m256i D3 = _mm256_xor_si256(C2, rol_avx2<1>(C4));
+			const __m256i D4 = _mm256_xor_si256(C3, rol_avx2<1>(C0));
+
+			const __m256i B0 = _mm256_xor_si256(S[0], D0);
+			const __m256i B10 = rol_avx2<1>(_mm256_xor_si256(S[1], D1));
+			const __m256i B20 = rol_avx2<62>(_mm256_xor_si256(S[2], D2));
+			const __m256i B5 = rol_avx2<28>(_mm256_xor_si256(S[3], D3));
+			const __m256i B15 = rol_avx2<27>(_mm256_xor_si256(S[4], D4));
+
+			const __m256i B16 = rol_avx2<36>(_mm256_xor_si256(S[5], D0));
+			const __m256i B1 = rol_avx2<44>(_mm256_xor_si256(S[6], D1));
+			const __m256i B11 = rol_avx2<6>(_mm256_xor_si256(S[7], D2));
+			const __m256i B21 = rol_avx2<55>(_mm256_xor_si256(S[8], D3));
+			const __m256i B6 = rol_avx2<20>(_mm256_xor_si256(S[9], D4));
+
+			const __m256i B7 = rol_avx2<3>(_mm256_xor_si256(S[10], D0));
+			const __m256i B17 = rol_avx2<10>(_mm256_xor_si256(S[11], D1));
+			const __m256i B2 = rol_avx2<43>(_mm256_xor_si256(S[12], D2));
+			const __m256i B12 = rol_avx2<25>(_mm256_xor_si256(S[13], D3));
+			const __m256i B22 = rol_avx2<39>(_mm256_xor_si256(S[14], D4));
+
+			const __m256i B23 = rol_avx2<41>(_mm256_xor_si256(S[15], D0));
+			const __m256i B8 = rol_avx2<45>(_mm256_xor_si256(S[16], D1));
+			const __m256i B18 = rol_avx2<15>(_mm256_xor_si256(S[17], D2));
+			const __m256i B3 = rol_avx2<21>(_mm256_xor_si256(S[18], D3));
+			const __m256i B13 = rol_avx2<8>(_mm256_xor_si256(S[19], D4));
+
+			const __m256i B14 = rol_avx2<18>(_mm256_xor_si256(S[20], D0));
+			const __m256i B24 = rol_avx2<2>(_mm256_xor_si256(S[21], D1));
+			const __m256i B9 = rol_avx2<61>(_mm256_xor_si256(S[22], D2));
+			const __m256i B19 = rol_avx2<56>(_mm256_xor_si256(S[23], D3));
+			const __m256i B4 = rol_avx2<14>(_mm256_xor_si256(S[24], D4));
+
+			S[0] = _mm256_xor_si256(B0, _mm256_andnot_si256(B1, B2));
+			S[1] = _mm256_xor_si256(B1, _mm256_andnot_si256(B2, B3));
+			S[2] = _mm256_xor_si256(B2, _mm256_andnot_si256(B3, B4));
+			S[3] = _mm256_xor_si256(B3, _mm256_andnot_si256(B4, B0));
+			S[4] = _mm256_xor_si256(B4, _mm256_andnot_si256(B0, B1));
+
+			S[5] = _mm256_xor_si256(B5, _mm256_andnot_si256(B6, B7));
+			S[6] = _mm256_xor_si256(B6, _mm256_andnot_si256(B7, B8));
+			S[7] = _mm256_xor_si256(B7, _mm256_andnot_si256(B8, B9));
+			S[8] = _mm256_xor_si256(B8, _mm256_andnot_si256(B9, B5));
+			S[9] = _mm256_xor_si256(B9, _mm256_andnot_si256(B5, B6));
+
+			S[10] = _mm256_xor_si256(B10, _mm256_andnot_si256(B11, B12));
+			S[11] = _mm256_xor_si256(B11, _mm256_andnot_si256(B12, B13));
+			S[12] = _mm256_xor_si256(B12, _mm256_andnot_si256(B13, B14));
+			S[13] = _mm256_xor_si256(B13, _mm256_andnot_si256(B14, B10));
+			S[14] = _mm256_xor_si256(B14, _mm256_andnot_si256(B10, B11));
+
+			S[15] = _mm256_xor_si256(B15, _mm256_andnot_si256(B16, B17));
+			S[16] = _mm256_xor_si256(B16, _mm256_andnot_si256(B17, B18));
+			S[17] = _mm256_xor_si256(B17, _mm256_andnot_si256(B18, B19));
+			S[18] = _mm256_xor_si256(B18, _mm256_andnot_si256(B19, B15));
+			S[19] = _mm256_xor_si256(B19, _mm256_andnot_si256(B15, B16));
+
+			S[20] = _mm256_xor_si256(B20, _mm256_andnot_si256(B21, B22));
+			S[21] = _mm256_xor_si256(B21, _mm256_andnot_si256(B22, B23));
+			S[22] = _mm256_xor_si256(B22, _mm256_andnot_si256(B23, B24));
+			S[23] = _mm256_xor_si256(B23, _mm256_andnot_si256(B24, B20));
+			S[24] = _mm256_xor_si256(B24, _mm256_andnot_si256(B20, B21));
+
+			S[0] = _mm256_xor_si256(S[0], _mm256_set1_epi64x(static_cast<long long>(sha3_constants<void>::RC[round])));
+		}
+
+		for (int i = 0; i < 25; i++)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(A + i * 4), S[i]);
+	}
+
+	template<int R>
+	DIGESTPP_TARGET("avx512f") inline void transform_x8_avx512(uint64_t* A)
+	{
+		__m512i S[25];
+		for (int i = 0; i < 25; i++)
+			S[i] = _mm512_loadu_si512(A + i * 8);
+
+		for (int round = 24 - R; round < 24; round++)
+		{
+			// 0x96 is a three-way xor and 0xD2 is a ^ (~b & c), the whole chi step
+			const __m512i C0 = _mm512_ternarylogic_epi64(_mm512_xor_si512(S[0], S[5]), S[10], _mm512_xor_si512(S[15], S[20]), 0x96);
+			const __m512i C1 = _mm512_ternarylogic_epi64(_mm512_xor_si512(S[1], S[6]), S[11], _mm512_xor_si512(S[16], S[21]), 0x96);
+			const __m512i C2 = _mm512_ternarylogic_epi64(_mm512_xor_si512(S[2], S[7]), S[12], _mm512_xor_si512(S[17], S[22]), 0x96);
+			const __m512i C3 = _mm512_ternarylogic_epi64(_mm512_xor_si512(S[3], S[8]), S[13], _mm512_xor_si512(S[18], S[23]), 0x96);
+			const __m512i C4 = _mm512_ternarylogic_epi64(_mm512_xor_si512(S[4], S[9]), S[14], _mm512_xor_si512(S[19], S[24]), 0x96);
+
+			const __m512i D0 = _mm512_xor_si512(C4, rol_avx512<1>(C1));
+			const __m512i D1 = _mm512_xor_si512(C0, rol_avx512<1>(C2));
+			const __m512i D2 = _mm512_xor_si512(C1, rol_avx512<1>(C3));
+			const __m512i D3 = _mm512_xor_si512(C2, rol_avx512<1>(C4));
+			const __m512i D4 = _mm512_xor_si512(C3, rol_avx512<1>(C0));
+
+			const __m512i B0 = _mm512_xor_si512(S[0], D0);
+			const __m512i B10 = rol_avx512<1>(_mm512_xor_si512(S[1], D1));
+			const __m512i B20 = rol_avx512<62>(_mm512_xor_si512(S[2], D2));
+			const __m512i B5 = rol_avx512<28>(_mm512_xor_si512(S[3], D3));
+			const __m512i B15 = rol_avx512<27>(_mm512_xor_si512(S[4], D4));
+
+			const __m512i B16 = rol_avx512<36>(_mm512_xor_si512(S[5], D0));
+			const __m512i B1 = rol_avx512<44>(_mm512_xor_si512(S[6], D1));
+			const __m512i B11 = rol_avx512<6>(_mm512_xor_si512(S[7], D2));
+			const __m512i B21 = rol_avx512<55>(_mm512_xor_si512(S[8], D3));
+			const __m512i B6 = rol_avx512<20>(_mm512_xor_si512(S[9], D4));
+
+			const __m512i B7 = rol_avx512<3>(_mm512_xor_si512(S[10], D0));
+			const __m512i B17 = rol_avx512<10>(_mm512_xor_si512(S[11], D1));
+			const __m512i B2 = rol_avx512<43>(_mm512_xor_si512(S[12], D2));
+			const __m512i B12 = rol_avx512<25>(_mm512_xor_si512(S[13], D3));
+			const __m512i B22 = rol_avx512<39>(_mm512_xor_si512(S[14], D4));
+
+			const __m512i B23 = rol_avx512<41>(_mm512_xor_si512(S[15], D0));
+			const __m512i B8 = rol_avx512<45>(_mm512_xor_si512(S[16], D1));
+			const __m512i B18 = rol_avx512<15>(_mm512_xor_si512(S[17], D2));
+			const __m512i B3 = rol_avx512<21>(_mm512_xor_si512(S[18], D3));
+			const __m512i B13 = rol_avx512<8>(_mm512_xor_si512(S[19], D4));
+
+			const __m512i B14 = rol_avx512<18>(_mm512_xor_si512(S[20], D0));
+			const __m512i B24 = rol_avx512<2>(_mm512_xor_si512(S[21], D1));
+			const __m512i B9 = rol_avx512<61>(_mm512_xor_si512(S[22], D2));
+			const __m512i B19 = rol_avx512<56>(_mm512_xor_si512(S[23], D3));
+			const __m512i B4 = rol_avx512<14>(_mm512_xor_si512(S[24], D4));
+
+			S[0] = _mm512_ternarylogic_epi64(B0, B1, B2, 0xD2);
+			S[1] = _mm512_ternarylogic_epi64(B1, B2, B3, 0xD2);
+			S[2] = _mm512_ternarylogic_epi64(B2, B3, B4, 0xD2);
+			S[3] = _mm512_ternarylogic_epi64(B3, B4, B0, 0xD2);
+			S[4] = _mm512_ternarylogic_epi64(B4, B0, B1, 0xD2);
+
+			S[5] = _mm512_ternarylogic_epi64(B5, B6, B7, 0xD2);
+			S[6] = _mm512_ternarylogic_epi64(B6, B7, B8, 0xD2);
+			S[7] = _mm512_ternarylogic_epi64(B7, B8, B9, 0xD2);
+			S[8] = _mm512_ternarylogic_epi64(B8, B9, B5, 0xD2);
+			S[9] = _mm512_ternarylogic_epi64(B9, B5, B6, 0xD2);
+
+			S[10] = _mm512_ternarylogic_epi64(B10, B11, B12, 0xD2);
+			S[11] = _mm512_ternarylogic_epi64(B11, B12, B13, 0xD2);
+			S[12] = _mm512_ternarylogic_epi64(B12, B13, B14, 0xD2);
+			S[13] = _mm512_ternarylogic_epi64(B13, B14, B10, 0xD2);
+			S[14] = _mm512_ternarylogic_epi64(B14, B10, B11, 0xD2);
+
+			S[15] = _mm512_ternarylogic_epi64(B15, B16, B17, 0xD2);
+			S[16] = _mm512_ternarylogic_epi64(B16, B17, B18, 0xD2);
+			S[17] = _mm512_ternarylogic_epi64(B17, B18, B19, 0xD2);
+			S[18] = _mm512_ternarylogic_epi64(B18, B19, B15, 0xD2);
+			S[19] = _mm512_ternarylogic_epi64(B19, B15, B16, 0xD2);
+
+			S[20] = _mm512_ternarylogic_epi64(B20, B21, B22, 0xD2);
+			S[21] = _mm512_ternarylogic_epi64(B21, B22, B23, 0xD2);
+			S[22] = _mm512_ternarylogic_epi64(B22, B23, B24, 0xD2);
+			S[23] = _mm512_ternarylogic_epi64(B23, B24, B20, 0xD2);
+			S[24] = _mm512_ternarylogic_epi64(B24, B20, B21, 0xD2);
+
+			S[0] = _mm512_xor_si512(S[0], _mm512_set1_epi64(static_cast<long long>(sha3_constants<void>::RC[round])));
+		}
+
+		for (int i = 0; i < 25; i++)
+			_mm512_storeu_si512(A + i * 8, S[i]);
+	}
+#endif
+
+	// Number of states the widest available kernel advances per call: 8, 4 or 1.
+	inline size_t multi_lanes()
+	{
+#ifdef DIGESTPP_HAS_X86_SIMD
+		if (cpu().avx512f)
+			return 8;
+		if (cpu().avx2)
+			return 4;
+#endif
+		return 1;
+	}
+
+	// Permute L lane-interleaved states, using SIMD when the CPU has a kernel of width L.
+	template<int R, size_t L>
+	inline void transform_multi(uint64_t* A)
+	{
+#ifdef DIGESTPP_HAS_X86_SIMD
+		if (L == 4 && cpu().avx2)
+			return transform_x4_avx2<R>(A);
+		if (L == 8 && cpu().avx512f)
+			return transform_x8_avx512<R>(A);
+#endif
+		transform_multi_scalar<R, L>(A);
+	}
+
+	// Absorb num_blks full-rate blocks into each of L states; data[l] advances by rate / 8 bytes per block.
+	template<int R, size_t L>
+	inline void transform_multi(const unsigned char* const* data, uint64_t num_blks, uint64_t* A, size_t rate)
+	{
+		const size_t r = rate / 8;
+		const size_t r64 = rate / 64;
+		for (uint64_t blk = 0; blk < num_blks; blk++)
+		{
+			for (size_t l = 0; l < L; l++)
+			{
+				for (size_t i = 0; i < r64; i++)
+				{
+					uint64_t w;
+					memcpy(&w, data[l] + blk * r + i * 8, 8);
+					A[i * L + l] ^= w;
+				}
+			}
+			transform_multi<R, L>(A);
+		}
+	}
+
+} // namespace sha3_functions
+
+} // namespace detail
+
+} // namespace digestpp
+
+#endif // DIGESTPP_PROVIDERS_KECCAK_MULTI_HPP
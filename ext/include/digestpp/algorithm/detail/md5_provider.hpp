@@ -48,6 +48,7 @@ class md5_provider
 {
 public:
 	static const bool is_xof = false;
+	static const size_t fixed_hash_size = 128;
 
 	md5_provider()
 	{
@@ -38,6 +38,7 @@ class sha1_provider
 {
 public:
 	static const bool is_xof = false;
+	static const size_t fixed_hash_size = 160;
 
 	sha1_provider()
 	{
@@ -9,6 +9,7 @@ This code is written by kerukuro and released into public domain.
 #include "../../detail/absorb_data.hpp"
 #include "../../detail/validate_hash_size.hpp"
 #include "constants/sha2_constants.hpp"
+#include "sha2_simd.hpp"
 #include <array>
 
 namespace digestpp
@@ -79,6 +80,7 @@ class sha2_provider
 {
 public:
 	static const bool is_xof = false;
+	static const size_t fixed_hash_size = O;
 
 	template<typename t=T, size_t o=O, typename std::enable_if<o && (sizeof(t) == 4 || o == 384)>::type* = nullptr>
 	sha2_provider()
@@ -201,6 +203,9 @@ public:
 private:
 	inline void transform(const unsigned char* data, size_t num_blks)
 	{
+		if (sha2_simd_functions::transform(H.data(), data, num_blks))
+			return;
+
 		for (size_t blk = 0; blk < num_blks; blk++)
 		{
 			T M[16];
@@ -0,0 +1,97 @@
+/*
+This code is written by kerukuro and released into public domain.
+*/
+
+#ifndef DIGESTPP_PROVIDERS_SHA2_SIMD_HPP
+#define DIGESTPP_PROVIDERS_SHA2_SIMD_HPP
+
+#include "../../detail/cpu_features.hpp"
+#include "constants/sha2_constants.hpp"
+#include <cstddef>
+
+namespace digestpp
+{
+
+namespace detail
+{
+
+namespace sha2_simd_functions
+{
+#ifdef DIGESTPP_HAS_X86_SIMD
+	// SHA-256 compression with the SHA extensions. The state is kept as ABEF/CDGH register pairs,
+	// the layout sha256rnds2 expects, and each group of four rounds consumes one message vector.
+	DIGESTPP_TARGET("sha,sse4.1") inline void transform_shani(uint32_t* H, const unsigned char* data, size_t num_blks)
+	{
+		const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+		const uint32_t* K = sha256_constants<void>::K;
+
+		__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(H)), 0xB1);
+		__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(H + 4)), 0x1B);
+		__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+		state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+		for (size_t blk = 0; blk < num_blks; blk++, data += 64)
+		{
+			const __m128i abef = state0;
+			const __m128i cdgh = state1;
+			__m128i W[4];
+
+			for (int g = 0; g < 16; g++)
+			{
+				if (g < 4)
+					W[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + g * 16)), bswap);
+
+				__m128i msg = _mm_add_epi32(W[g % 4], _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + g * 4)));
+				state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+				if (g >= 3 && g <= 14)
+				{
+					__m128i& next = W[(g + 1) % 4];
+					next = _mm_add_epi32(next, _mm_alignr_epi8(W[g % 4], W[(g + 3) % 4], 4));
+					next = _mm_sha256msg2_epu32(next, W[g % 4]);
+				}
+				msg = _mm_shuffle_epi32(msg, 0x0E);
+				state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+				if (g >= 1 && g <= 12)
+					W[(g + 3) % 4] = _mm_sha256msg1_epu32(W[(g + 3) % 4], W[g % 4]);
+			}
+
+			state0 = _mm_add_epi32(state0, abef);
+			state1 = _mm_add_epi32(state1, cdgh);
+		}
+
+		tmp = _mm_shuffle_epi32(state0, 0x1B);
+		state1 = _mm_shuffle_epi32(state1, 0xB1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(H), _mm_blend_epi16(tmp, state1, 0xF0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(H + 4), _mm_alignr_epi8(state1, tmp, 8));
+	}
+#endif
+
+	// Whole-block SHA-256 compression; returns false when the CPU lacks the SHA extensions.
+	inline bool transform(uint32_t* H, const unsigned char* data, size_t num_blks)
+	{
+#ifdef DIGESTPP_HAS_X86_SIMD
+		if (cpu().sha && cpu().sse41)
+		{
+			transform_shani(H, data, num_blks);
+			return true;
+		}
+#else
+		(void)H;
+		(void)data;
+		(void)num_blks;
+#endif
+		return false;
+	}
+
+	// SHA-384 and SHA-512/t always use the scalar transform.
+	inline bool transform(uint64_t*, const unsigned char*, size_t)
+	{
+		return false;
+	}
+}
+
+} // namespace detail
+
+} // namespace digestpp
+
+#endif // DIGESTPP_PROVIDERS_SHA2_SIMD_HPP
@@ -47,6 +47,7 @@ class sm3_provider
 {
 public:
 	static const bool is_xof = false;
+	static const size_t fixed_hash_size = 256;
 
 	sm3_provider()
 	{
@@ -36,6 +36,7 @@ class whirlpool_provider
 {
 public:
 	static const bool is_xof = false;
+	static const size_t fixed_hash_size = 512;
 
 	whirlpool_provider()
 	{
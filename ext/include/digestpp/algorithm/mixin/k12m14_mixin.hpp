@@ -46,6 +46,23 @@ public:
 	{
 		return set_customization(std::string(reinterpret_cast<const char*>(customization), customization_len));
 	}
+
+	/**
+	 * \brief Set the number of threads used to hash leaf chunks
+	 *
+	 * Chunks after the first 8192 bytes are independent leaves of the hash tree. With more than one
+	 * thread, leaves of a single absorb call are hashed concurrently and their chaining values are
+	 * absorbed in order, so the output does not depend on the thread count.
+	 *
+	 * \param[in] threads Number of threads; 0 means one per hardware thread, 1 (default) hashes serially
+	 * \return Reference to hasher
+	 */
+	inline hasher<T, mixin::k12m14_mixin>& set_threads(size_t threads)
+	{
+		auto& k12m14 = static_cast<hasher<T, mixin::k12m14_mixin>&>(*this);
+		k12m14.provider.set_threads(threads);
+		return k12m14;
+	}
 };
 
 } // namespace mixin
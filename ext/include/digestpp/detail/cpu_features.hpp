@@ -0,0 +1,108 @@
+/*
+This code is written by kerukuro and released into public domain.
+*/
+
+#ifndef DIGESTPP_DETAIL_CPU_FEATURES_HPP
+#define DIGESTPP_DETAIL_CPU_FEATURES_HPP
+
+#include <cstdint>
+
+// Define DIGESTPP_NO_SIMD to build only the portable transforms.
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) && !defined(DIGESTPP_NO_SIMD)
+#define DIGESTPP_HAS_X86_SIMD 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC allows intrinsics in any function, GCC and Clang need them enabled per function.
+#if defined(DIGESTPP_HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define DIGESTPP_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DIGESTPP_TARGET(isa)
+#endif
+
+namespace digestpp
+{
+namespace detail
+{
+
+// Instruction set extensions relevant to the accelerated transforms.
+struct cpu_features
+{
+	bool ssse3 = false;
+	bool sse41 = false;
+	bool avx2 = false;
+	bool avx512f = false;
+	bool sha = false;
+};
+
+#ifdef DIGESTPP_HAS_X86_SIMD
+inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#ifdef _MSC_VER
+	int r[4];
+	__cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (int i = 0; i < 4; i++)
+		regs[i] = static_cast<uint32_t>(r[i]);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Read XCR0 to find out which register files the OS saves on context switch.
+inline uint64_t xgetbv0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+#endif
+
+inline cpu_features detect_cpu_features()
+{
+	cpu_features f;
+#ifdef DIGESTPP_HAS_X86_SIMD
+	uint32_t r[4];
+	cpuid(0, 0, r);
+	const uint32_t max_leaf = r[0];
+	if (max_leaf < 1)
+		return f;
+
+	cpuid(1, 0, r);
+	f.ssse3 = (r[2] >> 9) & 1;
+	f.sse41 = (r[2] >> 19) & 1;
+	const bool osxsave = (r[2] >> 27) & 1;
+	const uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+	const bool os_avx = (xcr0 & 0x06) == 0x06;
+	const bool os_avx512 = (xcr0 & 0xe6) == 0xe6;
+
+	if (max_leaf >= 7)
+	{
+		cpuid(7, 0, r);
+		f.avx2 = os_avx && ((r[1] >> 5) & 1);
+		f.avx512f = os_avx512 && ((r[1] >> 16) & 1);
+		f.sha = (r[1] >> 29) & 1;
+	}
+#endif
+	return f;
+}
+
+// Features of the running CPU, detected once on first use.
+inline const cpu_features& cpu()
+{
+	static const cpu_features features = detect_cpu_features();
+	return features;
+}
+
+} // namespace detail
+} // namespace digestpp
+
+#endif // DIGESTPP_DETAIL_CPU_FEATURES_HPP
@@ -0,0 +1,98 @@
+/*
+This code is written by kerukuro and released into public domain.
+*/
+
+#ifndef DIGESTPP_DETAIL_FILE_SOURCE_HPP
+#define DIGESTPP_DETAIL_FILE_SOURCE_HPP
+
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DIGESTPP_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace digestpp
+{
+namespace detail
+{
+
+// Streaming reads use a whole number of pages, which is also a whole number of blocks
+// for every power-of-two block size.
+const size_t file_read_size = 64 * 1024;
+
+// Feed the contents of a file to sink(const unsigned char*, size_t).
+// The file is memory-mapped when possible, so a block-aligned sink reads it without any copies;
+// if mapping fails the file is read in file_read_size pieces instead.
+template<typename Sink>
+inline void read_file(const std::string& path, Sink sink)
+{
+#ifdef DIGESTPP_HAS_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("cannot open file " + path);
+
+	struct stat st;
+	if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+	{
+		size_t size = static_cast<size_t>(st.st_size);
+		void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED)
+		{
+			::madvise(map, size, MADV_SEQUENTIAL);
+			try
+			{
+				sink(static_cast<const unsigned char*>(map), size);
+			}
+			catch (...)
+			{
+				::munmap(map, size);
+				::close(fd);
+				throw;
+			}
+			::munmap(map, size);
+			::close(fd);
+			return;
+		}
+	}
+
+	std::vector<unsigned char> buffer(file_read_size);
+	for (;;)
+	{
+		ssize_t got = ::read(fd, buffer.data(), buffer.size());
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got < 0)
+		{
+			::close(fd);
+			throw std::runtime_error("cannot read file " + path);
+		}
+		if (got == 0)
+			break;
+		sink(buffer.data(), static_cast<size_t>(got));
+	}
+	::close(fd);
+#else
+	std::ifstream file(path, std::ios_base::in | std::ios_base::binary);
+	if (!file)
+		throw std::runtime_error("cannot open file " + path);
+
+	std::vector<unsigned char> buffer(file_read_size);
+	while (file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+		sink(buffer.data(), buffer.size());
+	if (file.gcount())
+		sink(buffer.data(), static_cast<size_t>(file.gcount()));
+#endif
+}
+
+} // namespace detail
+} // namespace digestpp
+
+#endif // DIGESTPP_DETAIL_FILE_SOURCE_HPP
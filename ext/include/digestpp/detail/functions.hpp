@@ -103,6 +103,15 @@ inline void zero_memory(std::string& s)
 		zero_memory(&s[0], s.size());
 }
 
+// Compare two buffers in time that depends only on their length, not on where they differ.
+inline bool constant_time_equal(const unsigned char* a, const unsigned char* b, size_t n)
+{
+	volatile unsigned char diff = 0;
+	for (size_t i = 0; i < n; i++)
+		diff = static_cast<unsigned char>(diff | (a[i] ^ b[i]));
+	return diff == 0;
+}
+
 
 } // namespace detail
 } // namespace digestpp
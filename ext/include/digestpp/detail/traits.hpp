@@ -6,6 +6,9 @@ This code is written by kerukuro and released into public domain.
 #define DIGESTPP_DETAIL_TRAITS_HPP
 
 #include <cstddef> // needed for testing std::byte
+#include <iterator>
+#include <memory>
+#include <type_traits>
 
 namespace digestpp
 {
@@ -18,6 +21,20 @@ struct is_xof
 	static const bool value = T::is_xof;
 };
 
+// Output size in bits of providers that fix it in the type, which declare it as
+// fixed_hash_size; 0 when it is chosen at run time.
+template <typename T, typename = void>
+struct fixed_hash_size
+{
+	static const size_t value = 0;
+};
+
+template <typename T>
+struct fixed_hash_size<T, decltype(void(T::fixed_hash_size))>
+{
+	static const size_t value = T::fixed_hash_size;
+};
+
 template <typename T>
 struct is_byte
 {
@@ -29,6 +46,35 @@ struct is_byte
 			std::is_same<T, unsigned char>::value;
 };
 
+// Iterators over contiguous storage of bytes, which can be absorbed as a single span.
+#if defined(__cpp_lib_concepts) && __cpp_lib_concepts >= 202002L
+template <typename IT>
+struct is_contiguous_byte_iterator
+{
+	static const bool value = std::contiguous_iterator<IT> &&
+			is_byte<typename std::remove_cv<std::iter_value_t<IT>>::type>::value;
+};
+
+template <typename IT>
+inline auto to_pointer(IT it)
+{
+	return std::to_address(it);
+}
+#else
+template <typename IT>
+struct is_contiguous_byte_iterator
+{
+	static const bool value = std::is_pointer<IT>::value &&
+			is_byte<typename std::remove_cv<typename std::remove_pointer<IT>::type>::type>::value;
+};
+
+template <typename IT>
+inline IT to_pointer(IT it)
+{
+	return it;
+}
+#endif
+
 } // namespace detail
 } // namespace digestpp
 
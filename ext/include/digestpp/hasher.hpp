@@ -16,6 +16,9 @@ This code is written by kerukuro and released into public domain.
 
 #include "detail/traits.hpp"
 #include "detail/stream_width_fixer.hpp"
+#include "detail/file_source.hpp"
+#include "detail/hex.hpp"
+#include "detail/functions.hpp"
 #include "algorithm/mixin/null_mixin.hpp"
 
 namespace digestpp
@@ -131,7 +134,8 @@ class hasher : public Mixin<HashProvider>
 	template<typename T, typename std::enable_if<detail::is_byte<T>::value>::type* = nullptr>
 	inline hasher& absorb(std::basic_istream<T>& istr)
 	{
-		const int tmp_buffer_size = 10000;
+		// a power of two, so each read is a whole number of blocks for the 64- and 128-byte block hashes
+		const int tmp_buffer_size = 16384;
 		unsigned char buffer[tmp_buffer_size];
 		while (istr.read(reinterpret_cast<T*>(buffer), sizeof(buffer)))
 		{
@@ -145,8 +149,35 @@ class hasher : public Mixin<HashProvider>
 		return *this;
 	}
 
+	/**
+	 * \brief Absorbs the contents of a file
+	 *
+	 * The file is memory-mapped with sequential access advice where the platform supports it and
+	 * handed to the algorithm in one piece, so full blocks are processed straight from the mapping.
+	 * If the file cannot be mapped (e.g. a pipe or an empty file), it is read in page-sized chunks.
+	 *
+	 * \param[in] path Path of the file to absorb
+	 * \return Reference to *this
+	 * \throw std::runtime_error if the file cannot be opened or read
+	 *
+	 * @par Example:\n
+	 * @code // Calculate BLAKE2b-256 digest of a file and output it in hex format
+	 * std::cout << digestpp::blake2b(256).absorb_file("filename").hexdigest() << std::endl;
+	 * @endcode
+	 */
+	inline hasher& absorb_file(const std::string& path)
+	{
+		detail::read_file(path, [this](const unsigned char* data, size_t len) { provider.update(data, len); });
+		return *this;
+	}
+
 	/**
 	 * \brief Absorbs bytes from an iterator sequence
+	 *
+	 * Iterators over contiguous byte storage (pointers, std::vector, std::string, std::array)
+	 * are absorbed as a single span. Other sequences are gathered into a staging buffer and
+	 * absorbed a buffer at a time.
+	 *
 	 * \param[in] begin Begin iterator
 	 * \param[in] end End iterator
 	 * \return Reference to *this
@@ -161,11 +192,7 @@ class hasher : public Mixin<HashProvider>
 	template<typename IT>
 	inline hasher& absorb(IT begin, IT end)
 	{
-		while (begin != end)
-		{
-			unsigned char byte = *begin++;
-			provider.update(&byte, 1);
-		}
+		absorb_range(begin, end, std::integral_constant<bool, detail::is_contiguous_byte_iterator<IT>::value>());
 		return *this;
 	}
 
@@ -213,9 +240,7 @@ class hasher : public Mixin<HashProvider>
 	template<typename OI, typename H=HashProvider, typename std::enable_if<detail::is_xof<H>::value>::type* = nullptr>
 	inline void squeeze(size_t len, OI it)
 	{
-		std::vector<unsigned char> hash(len);
-		provider.squeeze(&hash[0], len);
-		std::copy(hash.begin(), hash.end(), it);
+		squeeze_chunks(len, [&it](const unsigned char* chunk, size_t, size_t n) { it = std::copy(chunk, chunk + n, it); });
 	}
 
 	/**
@@ -228,7 +253,7 @@ class hasher : public Mixin<HashProvider>
 	 * \available_if HashProvider is an extendable output function (XOF)
 	 *
 	 * \param[in] len Size of data to squeeze (in bytes)
-	 * \return Calculated digest as a hexademical string
+	 * \return Calculated digest as a hexademical string; the string is the only allocation
 	 * @par Example:\n
 	 * @code // Generate 64-byte digest using customizable cSHAKE-256 algorithm and print it in hex format
 	 * digestpp::cshake256 xof;
@@ -239,10 +264,36 @@ class hasher : public Mixin<HashProvider>
 	template<typename H=HashProvider, typename std::enable_if<detail::is_xof<H>::value>::type* = nullptr>
 	inline std::string hexsqueeze(size_t len)
 	{
-		std::ostringstream res;
-		res << std::setfill('0') << std::hex;
-		squeeze(len, std::ostream_iterator<detail::stream_width_fixer<unsigned int, 2>>(res, ""));
-		return res.str();
+		std::string res(len * 2, '0');
+		if (len)
+			hexsqueeze_to(&res[0], len);
+		return res;
+	}
+
+	/**
+	 * \brief Squeeze bytes and write them as hex into user-provided preallocated buffer.
+	 *
+	 * Exactly 2 * len lowercase hex characters are written; no terminating zero is added and no memory is allocated.
+	 * After each invocation of this function the internal state of the hasher changes
+	 * so that the next call will generate different (additional) output bytes.
+	 * To reset the state and start new digest calculation, use \ref reset function.
+	 *
+	 * \available_if HashProvider is an extendable output function (XOF)
+	 *
+	 * \param[out] out Buffer of at least 2 * len characters
+	 * \param[in] len Size of data to squeeze (in bytes)
+	 * @par Example:\n
+	 * @code // Format 32 bytes of KangarooTwelve output into a stack buffer
+	 * char hex[65] = {};
+	 * digestpp::k12().absorb("The quick brown fox jumps over the lazy dog").hexsqueeze_to(hex, 32);
+	 * @endcode
+	 */
+	template<typename H=HashProvider, typename std::enable_if<detail::is_xof<H>::value>::type* = nullptr>
+	inline void hexsqueeze_to(char* out, size_t len)
+	{
+		squeeze_chunks(len, [out](const unsigned char* chunk, size_t offset, size_t n) {
+			detail::hex_encode(chunk, n, out + 2 * offset);
+		});
 	}
 
 	/**
@@ -292,10 +343,93 @@ class hasher : public Mixin<HashProvider>
 	template<typename OI, typename H=HashProvider, typename std::enable_if<!detail::is_xof<H>::value>::type* = nullptr>
 	inline void digest(OI it) const
 	{
+		with_digest([&it](const unsigned char* hash, size_t len) { std::copy(hash, hash + len, it); });
+	}
+
+	/**
+	 * \brief Return binary digest as a fixed-size array.
+	 *
+	 * This function does not change the state of the hasher and can be called multiple times, producing the same result.
+	 * The digest is computed on the stack; no memory is allocated.
+	 *
+	 * \available_if HashProvider is a hash function (not XOF)
+	 *
+	 * \tparam N Digest size in bytes; must equal the output size of the hasher. Algorithms with a fixed
+	 * output size (MD5, SHA-1, SHA-224, SHA-256, SHA-384, SM3, Whirlpool) supply it by default and reject
+	 * any other N at compile time; for the others N is required and checked when called.
+	 * \return Calculated digest
+	 * \throw std::runtime_error if N does not match the output size specified in the hasher constructor.
+	 * @par Example:\n
+	 * @code // Compute binary digests without heap allocations
+	 * std::array<unsigned char, 32> d = digestpp::sha256().absorb("The quick brown fox jumps over the lazy dog").digest();
+	 * std::array<unsigned char, 32> b = digestpp::blake2b(256).absorb("The quick brown fox jumps over the lazy dog").digest<32>();
+	 * @endcode
+	 */
+	template<size_t N = detail::fixed_hash_size<HashProvider>::value / 8, typename H=HashProvider,
+		typename std::enable_if<!detail::is_xof<H>::value>::type* = nullptr>
+	inline std::array<unsigned char, N> digest() const
+	{
+		static_assert(N != 0, "digest<N>() needs the digest size in bytes for this algorithm");
+		static_assert(!detail::fixed_hash_size<H>::value || N == detail::fixed_hash_size<H>::value / 8,
+			"N does not match the digest size of this algorithm");
+		if (!detail::fixed_hash_size<H>::value && N != provider.hash_size() / 8)
+			throw std::runtime_error("Invalid digest size");
+
+		std::array<unsigned char, N> hash;
 		HashProvider copy(provider);
-		std::vector<unsigned char> hash(provider.hash_size() / 8);
-		copy.final(&hash[0]);
-		std::copy(hash.begin(), hash.end(), it);
+		copy.final(hash.data());
+		return hash;
+	}
+
+	/**
+	 * \brief Write hex digest into user-provided preallocated buffer.
+	 *
+	 * Exactly hash_size / 4 lowercase hex characters are written; no terminating zero is added.
+	 * For digests of up to 512 bits no memory is allocated.
+	 * This function does not change the state of the hasher and can be called multiple times, producing the same result.
+	 *
+	 * \available_if HashProvider is a hash function (not XOF)
+	 *
+	 * \param[out] out Buffer of at least hash_size / 4 characters
+	 * @par Example:\n
+	 * @code // Format a BLAKE2b-512 digest into a stack buffer
+	 * char hex[129] = {};
+	 * digestpp::blake2b().absorb("The quick brown fox jumps over the lazy dog").hexdigest_to(hex);
+	 * @endcode
+	 */
+	template<typename H=HashProvider, typename std::enable_if<!detail::is_xof<H>::value>::type* = nullptr>
+	inline void hexdigest_to(char* out) const
+	{
+		with_digest([out](const unsigned char* hash, size_t len) { detail::hex_encode(hash, len, out); });
+	}
+
+	/**
+	 * \brief Compare the digest with an expected binary digest in constant time.
+	 *
+	 * No hex is produced and, for digests of up to 512 bits, no memory is allocated. The comparison
+	 * takes the same time wherever the digests differ, so it is safe for verifying credentials and MACs.
+	 *
+	 * \available_if HashProvider is a hash function (not XOF)
+	 *
+	 * \param[in] expected Expected digest; must be of byte type (char, unsigned char or signed char)
+	 * \param[in] len Size of the expected digest (in bytes)
+	 * \return true if len equals the output size and all bytes match
+	 * @par Example:\n
+	 * @code // Verify a stored SHA-256 digest
+	 * unsigned char stored[32];
+	 * digestpp::sha256().absorb("secret").digest(stored, sizeof(stored));
+	 * bool ok = digestpp::sha256().absorb("secret").digest_equals(stored, sizeof(stored));
+	 * @endcode
+	 */
+	template<typename T, typename H=HashProvider,
+		typename std::enable_if<detail::is_byte<T>::value && !detail::is_xof<H>::value>::type* = nullptr>
+	inline bool digest_equals(const T* expected, size_t len) const
+	{
+		bool equal = false;
+		with_digest([&](const unsigned char* hash, size_t hash_len) {
+			equal = len == hash_len && detail::constant_time_equal(hash, reinterpret_cast<const unsigned char*>(expected), len);
+		});
+		return equal;
 	}
 
 	/**
@@ -315,10 +449,10 @@ class hasher : public Mixin<HashProvider>
 	template<typename H=HashProvider, typename std::enable_if<!detail::is_xof<H>::value>::type* = nullptr>
 	inline std::string hexdigest() const
 	{
-		std::ostringstream res;
-		res << std::setfill('0') << std::hex;
-		digest(std::ostream_iterator<detail::stream_width_fixer<unsigned int, 2>>(res, ""));
-		return res.str();
+		std::string res(provider.hash_size() / 4, '0');
+		if (!res.empty())
+			hexdigest_to(&res[0]);
+		return res;
 	}
 
 	/**
@@ -334,6 +468,65 @@ class hasher : public Mixin<HashProvider>
 	}
 
 private:
+	// Finalize a copy of the provider and pass the digest to f(const unsigned char*, size_t).
+	// Digests of common sizes stay on the stack; only very long ones (e.g. BLAKE2X) are allocated.
+	template<typename F>
+	inline void with_digest(F f) const
+	{
+		const size_t len = provider.hash_size() / 8;
+		HashProvider copy(provider);
+		unsigned char stack[64];
+		if (len <= sizeof(stack))
+		{
+			copy.final(stack);
+			f(stack, len);
+			detail::zero_memory(stack, sizeof(stack));
+			return;
+		}
+		std::vector<unsigned char> hash(len);
+		copy.final(&hash[0]);
+		f(hash.data(), len);
+	}
+
+	// Squeeze len bytes a stack buffer at a time, passing each piece to f(chunk, offset, n).
+	template<typename F>
+	inline void squeeze_chunks(size_t len, F f)
+	{
+		unsigned char chunk[256];
+		for (size_t offset = 0; offset < len; offset += sizeof(chunk))
+		{
+			const size_t n = std::min(sizeof(chunk), len - offset);
+			provider.squeeze(chunk, n);
+			f(chunk, offset, n);
+		}
+		detail::zero_memory(chunk, sizeof(chunk));
+	}
+
+	template<typename IT>
+	inline void absorb_range(IT begin, IT end, std::true_type)
+	{
+		if (begin != end)
+			provider.update(reinterpret_cast<const unsigned char*>(detail::to_pointer(begin)), static_cast<size_t>(end - begin));
+	}
+
+	template<typename IT>
+	inline void absorb_range(IT begin, IT end, std::false_type)
+	{
+		unsigned char buffer[1024];
+		size_t len = 0;
+		while (begin != end)
+		{
+			buffer[len++] = static_cast<unsigned char>(*begin++);
+			if (len == sizeof(buffer))
+			{
+				provider.update(buffer, len);
+				len = 0;
+			}
+		}
+		if (len)
+			provider.update(buffer, len);
+	}
+
 	friend Mixin<HashProvider>;
 	HashProvider provider;
 };
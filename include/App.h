@@ -0,0 +1,365 @@
+#ifndef OOP_APP_H
+#define OOP_APP_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <Channel.h>
+#include <ChannelTable.h>
+#include <LatencyHistogram.h>
+#include <ObjectPool.h>
+#include <OutputBuffer.h>
+#include <PersistentVector.h>
+#include <PasswordManager.h>
+#include <SubscriptionGraph.h>
+#include <User.h>
+#include <UserIndex.h>
+#include <WriteAheadLog.h>
+
+class Snapshot;
+
+// Per-stage latency of App::login, for export to monitoring.
+struct LoginStats {
+    LatencyHistogram lookup;
+    LatencyHistogram hash;
+    LatencyHistogram compare;
+    uint64_t attempts = 0;
+    uint64_t unknownUser = 0;
+    uint64_t wrongPassword = 0;
+
+    friend std::ostream& operator<<(std::ostream& os, const LoginStats& stats) {
+        os << "login attempts=" << stats.attempts << " unknown_user=" << stats.unknownUser
+           << " wrong_password=" << stats.wrongPassword << '\n';
+        os << "login.lookup " << stats.lookup << '\n';
+        os << "login.hash " << stats.hash << '\n';
+        os << "login.compare " << stats.compare << '\n';
+        return os;
+    }
+};
+
+class App {
+private:
+    using ChannelHandle = ObjectPool<Channel>::Handle;
+
+    // Copying an App is O(1): users, the channel table, the subscription graph
+    // and the index are shared with the copy until one side writes to them, and
+    // then only the touched leaves are cloned. A copy is a consistent snapshot
+    // for a reader thread while the original keeps taking writes.
+    //
+    // The users of a loaded snapshot are read from its mapping in place, and
+    // come first: users holds only those stored since, at positions from
+    // mapped.size() on. Users are never removed or changed once stored.
+    struct MappedUsers {
+        std::shared_ptr<const Snapshot> snapshot;
+        std::span<const PasswordManager::Digest> digests;
+        std::span<const PasswordManager::Salt> salts;
+        std::span<const uint64_t> nameOffsets;
+        std::string_view names;
+
+        [[nodiscard]] size_t size() const { return digests.size(); }
+        [[nodiscard]] std::string_view name(size_t i) const {
+            return names.substr(nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]);
+        }
+    } mapped;
+    PersistentVector<User> users;
+    // Channel data lives in the table, owners given by position in users. The
+    // views are made on first use by getChannels, each with a copy of its owner,
+    // since a user's place in users may move when a shared leaf is cloned.
+    // For the same reason users are only handed out by value.
+    // The table is on the heap so the views' pointer to it survives swap.
+    std::unique_ptr<ChannelTable> channelTable = std::make_unique<ChannelTable>();
+    ObjectPool<Channel> channelPool;
+    std::vector<ChannelHandle> channels;
+    // user position in users -> channel row, and back
+    SubscriptionGraph subscriptions;
+    // account name -> position in users; copies made for channel owners are not indexed
+    UserIndex userIndex;
+    LoginStats loginStats;
+    // Mutations are appended here once applied; not owned. logPosition is the
+    // last logged mutation reflected in this App while no log is attached.
+    WriteAheadLog* log = nullptr;
+    WriteAheadLog::Sequence logPosition = 0;
+
+    void record(LogRecordType type, std::initializer_list<std::string_view> payload) {
+        if (log)
+            log->append(type, payload);
+    }
+
+    [[nodiscard]] size_t userCount() const { return mapped.size() + users.size(); }
+    // A mapped user's name is interned when the User is made, not on load.
+    [[nodiscard]] User userAt(size_t position) const {
+        if (position < mapped.size())
+            return User(mapped.digests[position], mapped.name(position), mapped.salts[position]);
+        return users[position - mapped.size()];
+    }
+    [[nodiscard]] const PasswordManager::Digest& digestAt(size_t position) const {
+        return position < mapped.size() ? mapped.digests[position] : users[position - mapped.size()].getDigest();
+    }
+    [[nodiscard]] const PasswordManager::Salt& saltAt(size_t position) const {
+        return position < mapped.size() ? mapped.salts[position] : users[position - mapped.size()].getSalt();
+    }
+
+    uint32_t storeUser(const User& user, bool indexed) {
+        const auto position = static_cast<uint32_t>(userCount());
+        if (indexed)
+            userIndex.insert(user.getUsername(), position);
+        users.push_back(user);
+        const auto flag = static_cast<uint8_t>(indexed);
+        record(LogRecordType::user_stored, {WriteAheadLog::field(flag), WriteAheadLog::field(user.getDigest()),
+                                            WriteAheadLog::field(user.getSalt()), user.getUsername()});
+        return position;
+    }
+
+    // Redoes one logged mutation, without logging it again.
+    void apply(const WriteAheadLog::Record& entry);
+public:
+    App()=default;
+
+    // Shares everything but the channel views, which the copy makes when asked.
+    App(const App& other) : mapped(other.mapped), users(other.users), channelTable(std::make_unique<ChannelTable>(*other.channelTable)),
+        subscriptions(other.subscriptions), userIndex(other.userIndex), loginStats(other.loginStats),
+        logPosition(other.loggedThrough()) {}
+
+    // Throws std::logic_error while a log is attached: the log holds this App's
+    // history, so replaying it after the assignment would rebuild the old state.
+    // Detach it first, and attach a log that matches the new state.
+    App& operator=(const App& other)
+    {
+        if(this != &other)
+        {
+            if (log)
+                throw std::logic_error("Cannot assign to an App with a write-ahead log attached");
+            App copy(other);
+            swap(*this, copy);
+        }
+        return *this;
+    }
+
+    friend void swap(App& a, App& b) noexcept {
+        using std::swap;
+        swap(a.mapped, b.mapped);
+        swap(a.users, b.users);
+        swap(a.channelTable, b.channelTable);
+        swap(a.channelPool, b.channelPool);
+        swap(a.channels, b.channels);
+        swap(a.subscriptions, b.subscriptions);
+        swap(a.userIndex, b.userIndex);
+        swap(a.loginStats, b.loginStats);
+        swap(a.log, b.log);
+        swap(a.logPosition, b.logPosition);
+    }
+
+    // Bulk load: the index is sized once up front.
+    [[maybe_unused]] explicit App(const std::vector<User>& _users) {
+        userIndex.reserve(_users.size());
+        for (const auto& user : _users)
+            storeUser(user, !userIndex.contains(user.getUsername()));
+    }
+
+    // The view pool destroys its objects slab by slab.
+    ~App() {
+        std::cout<<"Delete App";
+    }
+
+     void signup()
+    {
+        std::cout<<"Welcome! Create a new account!\n";
+        std::cout<<"Username:";
+        std::string username, password;
+        std::cin>>username;
+        std::cout<<"Password:";
+        std::cin>>password;
+        if (userIndex.contains(username)) {
+            std::cout<<"Username already taken\n";
+            return;
+        }
+        PasswordManager::Salt salt=PasswordManager::make_salt();
+        PasswordManager::Digest hashedPassword= PasswordManager::hash_password(password, salt);
+        storeUser(User(hashedPassword, username, salt), true);
+    }
+
+    bool login(){
+        std::cout<<"Welcome back! Please log in!\n";
+        std::cout<<"Username:";
+        std::string username, password;
+        std::cin>>username;
+        std::cout<<"Password:";
+        std::cin>>password;
+        return login(username, password);
+    }
+
+    // Verifies against the stored salt and digest: one index probe, one BLAKE2b-512
+    // and one constant-time compare. Each stage is timed into loginStats.
+    bool login(std::string_view username, const std::string& password) {
+        using clock = std::chrono::steady_clock;
+        ++loginStats.attempts;
+
+        const auto start = clock::now();
+        const uint32_t position = userIndex.find(username);
+        const bool known = position != UserIndex::npos;
+        const auto found = clock::now();
+        loginStats.lookup.record(found - start);
+
+        // unknown names still pay for a hash, so response time does not reveal which accounts exist
+        static const User nobody;
+        const PasswordManager::Digest& stored = known ? digestAt(position) : nobody.getDigest();
+        const PasswordManager::Digest digest =
+            PasswordManager::hash_password(password, known ? saltAt(position) : nobody.getSalt());
+        const auto hashed = clock::now();
+        loginStats.hash.record(hashed - found);
+
+        const bool match = digestpp::detail::constant_time_equal(stored.data(), digest.data(), digest.size());
+        loginStats.compare.record(clock::now() - hashed);
+
+        if (!known) {
+            ++loginStats.unknownUser;
+            return false;
+        }
+        if (!match)
+            ++loginStats.wrongPassword;
+        return match;
+    }
+
+    [[nodiscard]] const LoginStats& getLoginStats() const { return loginStats; }
+
+    void addUser(const std::string& username) {
+        if (username.empty()) {
+            std::cerr << "Error: Username cannot be empty." << std::endl;
+            return;
+        }
+        if (userIndex.contains(username)) {
+            std::cerr << "Error: Username " << username << " already exists." << std::endl;
+            return;
+        }
+        storeUser(User(username), true);
+    }
+
+
+
+    // An owner with a registered account's name and credentials is shared with
+    // that account; any other owner is copied into the pool once.
+    void addChannel(const std::string& channelName, const User& owner) {
+        uint32_t position = userIndex.find(owner.getUsername());
+        if (position == UserIndex::npos || digestAt(position) != owner.getDigest() ||
+            saltAt(position) != owner.getSalt())
+            position = storeUser(owner, false);
+        channelTable->add(channelName, position);
+        record(LogRecordType::channel_added, {WriteAheadLog::field(position), channelName});
+    }
+
+    // A copy: a change made while a copy of the App exists may move the stored user.
+    [[nodiscard]] User getUser(size_t index) const {
+        if (index < userCount()) {
+            return userAt(index);
+        }
+        throw std::out_of_range("User index out of range");
+    }
+
+    // O(1) lookup by account name; a copy, or none if there is no such account.
+    [[nodiscard]] std::optional<User> findUser(std::string_view username) const {
+        const uint32_t index = userIndex.find(username);
+        if (index == UserIndex::npos)
+            return std::nullopt;
+        return userAt(index);
+    }
+
+    // Views of every channel, made for the channels added since the last call.
+    // The views live as long as the App.
+    [[nodiscard]] std::vector<Channel*> getChannels();
+
+    // Writes users with their credentials, channels, videos, the title index and
+    // the subscription graph to a snapshot file, replacing it atomically.
+    void saveSnapshot(const std::filesystem::path& path) const;
+    // Serves the App from a mapped snapshot, which it keeps mapped: users, the
+    // user index, channel names, video titles and the subscription graph are
+    // read in place, and later writes go to in-memory tables beside them. Only
+    // the channel columns, the counters and the title index are copied out.
+    // Does not check the section checksums, but every offset and id is checked
+    // against the arrays it points into, and a damaged snapshot throws
+    // std::runtime_error rather than loading.
+    explicit App(std::shared_ptr<const Snapshot> snapshot);
+    // Maps the snapshot, verifies every section's checksum and loads it.
+    [[nodiscard]] static App loadSnapshot(const std::filesystem::path& path);
+
+    // Replays the log's records newer than this App's state, then appends every
+    // later mutation to it, including those made through the channel views. A
+    // mutation is durable once log.sync(loggedThrough()) returns. The log must
+    // outlive the App or be detached first.
+    void attachLog(WriteAheadLog& wal);
+    [[maybe_unused]] void detachLog();
+    // Sequence of the last logged mutation reflected in this App; saved in snapshots.
+    [[nodiscard]] WriteAheadLog::Sequence loggedThrough() const { return log ? log->lastAppended() : logPosition; }
+
+    // Records the account as a subscriber of the channel at channelIndex and bumps its counter.
+    // False for unknown accounts or channels and for repeated subscribes.
+    bool subscribe(std::string_view username, size_t channelIndex) {
+        const uint32_t user = userIndex.find(username);
+        if (user == UserIndex::npos || channelIndex >= channelTable->size())
+            return false;
+        const auto row = static_cast<ChannelTable::Row>(channelIndex);
+        if (!subscriptions.subscribe(user, row))
+            return false;
+        channelTable->subscribe(row);
+        record(LogRecordType::subscribed, {WriteAheadLog::field(user), WriteAheadLog::field(row)});
+        return true;
+    }
+
+    bool unsubscribe(std::string_view username, size_t channelIndex) {
+        const uint32_t user = userIndex.find(username);
+        if (user == UserIndex::npos || channelIndex >= channelTable->size())
+            return false;
+        const auto row = static_cast<ChannelTable::Row>(channelIndex);
+        if (!subscriptions.unsubscribe(user, row))
+            return false;
+        channelTable->unsubscribe(row);
+        record(LogRecordType::unsubscribed, {WriteAheadLog::field(user), WriteAheadLog::field(row)});
+        return true;
+    }
+
+    // Published video titles containing every word of the query, oldest first.
+    // The views point into the string interner and stay valid.
+    [[nodiscard]] std::vector<std::string_view> searchVideos(std::string_view query, size_t limit = 100) const {
+        std::vector<std::string_view> found;
+        for (const auto& video : channelTable->searchVideos(query, limit))
+            found.push_back(channelTable->videoTitle(video.channel, video.video));
+        return found;
+    }
+
+    // Streaming export: one user per line, in the format of operator<<.
+    [[maybe_unused]] void exportUsers(std::ostream& os) const {
+        OutputBuffer out(os);
+        for (size_t i = 0; i < mapped.size(); i++)
+            out << "Username: " << mapped.name(i) << '\n';
+        users.forEach([&](const User& user) { out << user << '\n'; });
+    }
+
+    // Every channel in the format of operator<<, followed by an empty line.
+    // Reads the table directly, so it makes no views.
+    [[maybe_unused]] void exportChannels(std::ostream& os) const {
+        OutputBuffer out(os);
+        for (ChannelTable::Row row = 0; row < channelTable->size(); row++)
+            out << "Channel Name: " << channelTable->name(row) << '\n'
+                << "Subscriber Count: " << channelTable->subscribers(row) << '\n'
+                << "Owner: " << userAt(channelTable->owner(row)) << "\n\n";
+    }
+
+    // Users are identified by their position (see getUser), channels by their index.
+    [[nodiscard]] const SubscriptionGraph& getSubscriptions() const { return subscriptions; }
+
+    // Columnar view of all channels, for ranking and other full scans.
+    [[nodiscard]] const ChannelTable& getChannelTable() const { return *channelTable; }
+    // Publishes the current subscriber counts to the table's scan snapshot.
+    void refreshChannelStats() { channelTable->refreshSubscriberSnapshot(); }
+};
+
+#endif //OOP_APP_H
@@ -0,0 +1,264 @@
+#ifndef OOP_CHANNEL_H
+#define OOP_CHANNEL_H
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <ChannelTable.h>
+#include <OutputBuffer.h>
+#include <Playlist.h>
+#include <StringInterner.h>
+#include <TitleIndex.h>
+#include <User.h>
+#include <WriteAheadLog.h>
+
+class Snapshot;
+
+// View of one row of a ChannelTable. Channels created by App share the App's
+// table; a channel constructed on its own gets a private one-row table.
+// Views of an App with a write-ahead log record their mutations in it; a
+// channel on its own can be given a log of its own and rebuilt from it.
+class Channel {
+private:
+    std::unique_ptr<ChannelTable> ownTable;
+    ChannelTable* table;
+    ChannelTable::Row row;
+    WriteAheadLog* log = nullptr;
+    std::optional<User> ownOwner;
+protected:
+    User* owner;
+
+    void record(LogRecordType type, std::string_view text = {}) {
+        if (log)
+            log->append(type, {WriteAheadLog::field(row), text});
+    }
+
+    void record(LogRecordType type, uint64_t position, std::string_view text) {
+        if (log)
+            log->append(type, {WriteAheadLog::field(row), WriteAheadLog::field(position), text});
+    }
+
+    // Reads the channel row that starts every channel record; false if it is another channel's.
+    [[nodiscard]] bool ours(WriteAheadLog::PayloadReader& in) const { return in.take<ChannelTable::Row>() == row; }
+
+    // Redoes one logged mutation of this channel, without logging it again.
+    virtual void apply(const WriteAheadLog::Record& entry);
+
+    // A channel on its own, loaded from a snapshot of its one-row table.
+    Channel(std::shared_ptr<const Snapshot> snapshot, User* ownerPtr);
+    [[nodiscard]] const ChannelTable& channelTable() const { return *table; }
+public:
+    Channel(const std::string& channelName, User* ownerPtr)
+        : ownTable(std::make_unique<ChannelTable>()), table(ownTable.get()),
+          row(table->add(channelName, ChannelTable::no_owner)), owner(ownerPtr) {}
+    Channel(ChannelTable& channelTable, ChannelTable::Row tableRow, User* ownerPtr)
+        : ownTable(), table(&channelTable), row(tableRow), owner(ownerPtr) {}
+    // For owners that may move: the view keeps a copy of its own.
+    Channel(ChannelTable& channelTable, ChannelTable::Row tableRow, const User& ownerCopy)
+        : ownTable(), table(&channelTable), row(tableRow), ownOwner(ownerCopy), owner(&*ownOwner) {}
+    Channel(const Channel& other) = delete;
+    Channel& operator=(const Channel& other) = delete;
+    virtual ~Channel() = default;
+
+    friend std::ostream& operator<<(std::ostream& os, const Channel& channel) {
+        os << "Channel Name: " << channel.table->name(channel.row) << '\n';
+        os << "Subscriber Count: " << channel.table->subscribers(channel.row) << '\n';
+        os << "Owner: " << *(channel.owner);
+        return os;
+    }
+
+    friend OutputBuffer& operator<<(OutputBuffer& out, const Channel& channel) {
+        return out << "Channel Name: " << channel.table->name(channel.row) << '\n'
+                   << "Subscriber Count: " << channel.table->subscribers(channel.row) << '\n'
+                   << "Owner: " << *(channel.owner);
+    }
+
+    void subscribe() {
+        table->subscribe(row);
+        record(LogRecordType::channel_subscribed);
+    }
+
+    void unsubscribe() {
+        table->unsubscribe(row);
+        record(LogRecordType::channel_unsubscribed);
+    }
+
+    void publishVideo(const std::string& title) {
+        table->publishVideo(row, title);
+        record(LogRecordType::video_published, title);
+    }
+
+    // nullptr stops logging.
+    void attachLog(WriteAheadLog* channelLog) { log = channelLog; }
+    // Redoes the records after the given sequence that belong to this channel:
+    // subscriber changes, videos and, for a MusicChannel, songs, playlist and
+    // favorites. For a channel on its own and the log it wrote; App replays the
+    // records of its views itself. Throws std::runtime_error on a record that
+    // is not a channel mutation.
+    void replay(const WriteAheadLog& channelLog, WriteAheadLog::Sequence after = 0);
+
+    [[nodiscard]] std::string_view getChannelName() const { return table->name(row); }
+    [[maybe_unused]] [[nodiscard]] uint64_t getSubscriberCount() const { return table->subscribers(row); }
+};
+
+class MusicChannel : public Channel {
+private:
+    using SongId = Playlist::SongId;
+
+    StringInterner::Symbol musicLabel = StringInterner::empty;
+    // Every title the channel has seen gets a small id of its own, dense so the
+    // playlists can index by it; songs, the playlist and favorites hold these ids.
+    std::vector<StringInterner::Symbol> songTitles;  // by SongId
+    std::unordered_map<StringInterner::Symbol, SongId> songIds;
+    std::vector<SongId> songs;
+    Playlist playlist;
+    Playlist favorites;
+    TitleIndex songIndex;  // document ids are positions in songs
+
+    SongId intern(std::string_view title) {
+        const StringInterner::Symbol symbol = StringInterner::global().intern(title);
+        const auto [entry, inserted] = songIds.try_emplace(symbol, static_cast<SongId>(songTitles.size()));
+        if (inserted)
+            songTitles.push_back(symbol);
+        return entry->second;
+    }
+
+    [[nodiscard]] std::optional<SongId> idOf(std::string_view title) const {
+        const auto found = songIds.find(StringInterner::global().find(title));
+        if (found == songIds.end())
+            return std::nullopt;
+        return found->second;
+    }
+
+    [[nodiscard]] std::string_view titleOf(SongId id) const { return StringInterner::global().view(songTitles[id]); }
+
+    void display(OutputBuffer& out, std::string_view heading, const Playlist& list) const {
+        out << heading << getChannelName() << ":\n";
+        list.forEach([&](SongId id) { out << titleOf(id) << '\n'; });
+    }
+protected:
+    void apply(const WriteAheadLog::Record& entry) override;
+public:
+    MusicChannel(const std::string& channelName, User* ownerPtr) : Channel(channelName, ownerPtr), songTitles(), songIds(), songs(), playlist(), favorites(), songIndex() {}
+
+    MusicChannel(const MusicChannel& other) = delete;
+    MusicChannel& operator=(const MusicChannel& other) = delete;
+
+    // Loads a channel written by saveSnapshot. Its table row is read from the
+    // mapping in place; the songs are few, so they are interned and indexed
+    // again. Throws std::runtime_error if the snapshot is damaged.
+    MusicChannel(std::shared_ptr<const Snapshot> snapshot, User* ownerPtr);
+
+    // Writes the channel's row, videos, songs, playlist and favorites to a
+    // snapshot file of its own, replacing it atomically.
+    void saveSnapshot(const std::filesystem::path& path) const;
+
+    [[maybe_unused]] [[nodiscard]] std::string_view getLabel() const { return StringInterner::global().view(musicLabel); }
+
+    [[maybe_unused]] void setLabel(std::string_view label) { musicLabel = StringInterner::global().intern(label); }
+
+    void addSong(std::string_view song) {
+        songIndex.add(song);
+        songs.push_back(intern(song));
+        record(LogRecordType::song_added, song);
+    }
+
+    // Songs whose title contains every word of the query.
+    [[nodiscard]] std::vector<std::string> searchSongs(std::string_view query) const {
+        std::vector<std::string> found;
+        for (auto doc : songIndex.search(query))
+            found.emplace_back(titleOf(songs[doc]));
+        return found;
+    }
+
+    // The playlist holds each song once; these return false when there is nothing to do.
+    bool addToPlaylist(std::string_view song) {
+        return insertIntoPlaylist(song, playlist.size());
+    }
+
+    [[maybe_unused]] bool insertIntoPlaylist(std::string_view song, size_t position) {
+        if (!playlist.insert(position, intern(song)))
+            return false;
+        record(LogRecordType::playlist_inserted, position, song);
+        return true;
+    }
+
+    [[maybe_unused]] bool removeFromPlaylist(std::string_view song) {
+        const auto id = idOf(song);
+        if (!id || !playlist.erase(*id))
+            return false;
+        record(LogRecordType::playlist_removed, song);
+        return true;
+    }
+
+    [[maybe_unused]] bool moveInPlaylist(std::string_view song, size_t position) {
+        const auto id = idOf(song);
+        if (!id || !playlist.move(*id, position))
+            return false;
+        record(LogRecordType::playlist_moved, position, song);
+        return true;
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool inPlaylist(std::string_view song) const {
+        const auto id = idOf(song);
+        return id && playlist.contains(*id);
+    }
+
+    // Only songs on the playlist can become favorites.
+    bool markFavorite(std::string_view song) {
+        const auto id = idOf(song);
+        if (!id || !playlist.contains(*id) || !favorites.push_back(*id))
+            return false;
+        record(LogRecordType::favorite_marked, song);
+        return true;
+    }
+
+    [[maybe_unused]] bool unmarkFavorite(std::string_view song) {
+        const auto id = idOf(song);
+        if (!id || !favorites.erase(*id))
+            return false;
+        record(LogRecordType::favorite_unmarked, song);
+        return true;
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool isFavorite(std::string_view song) const {
+        const auto id = idOf(song);
+        return id && favorites.contains(*id);
+    }
+
+    // The display functions render into out; the overloads without one write
+    // to std::cout through a buffer of their own.
+    void displaySongs(OutputBuffer& out) const {
+        out << "Songs in " << getChannelName() << ":\n";
+        for (SongId id : songs) {
+            out << titleOf(id) << '\n';
+        }
+    }
+
+    void displayPlaylist(OutputBuffer& out) const { display(out, "Playlist in ", playlist); }
+
+    void displayFavorites(OutputBuffer& out) const { display(out, "Favorite songs in ", favorites); }
+
+    void displaySongs() const {
+        OutputBuffer out(std::cout);
+        displaySongs(out);
+    }
+
+    void displayPlaylist() const {
+        OutputBuffer out(std::cout);
+        displayPlaylist(out);
+    }
+
+    void displayFavorites() const {
+        OutputBuffer out(std::cout);
+        displayFavorites(out);
+    }
+};
+
+#endif //OOP_CHANNEL_H
@@ -0,0 +1,132 @@
+#ifndef OOP_CHANNELTABLE_H
+#define OOP_CHANNELTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <CopyOnWrite.h>
+#include <PersistentVector.h>
+#include <StringInterner.h>
+#include <StripedCounters.h>
+#include <TitleIndex.h>
+
+class Snapshot;
+class SnapshotWriter;
+
+// Column store for channel data. Counters and ids sit in separate columns
+// indexed by row, each stored in contiguous leaves, so scans over one attribute
+// (ranking by subscribers, grouping by owner) touch only that column. Names
+// and video titles are held as interned symbols; titles are cold and kept
+// apart from the hot columns.
+//
+// subscribe, unsubscribe and subscribers are safe to call from many threads at
+// once. Scans read a plain snapshot of the counts taken by refreshSubscriberSnapshot;
+// all other members need external synchronization.
+//
+// Copying a table is O(1): every column, the subscriber counters included, is
+// a persistent vector shared with the original, and a later write on either
+// side clones only the leaf it touches. Concurrent subscribes are lock-free
+// while the table shares no counter block with a copy; until each shared
+// block has been written once, subscribes need exclusive access (see
+// StripedCounters).
+class ChannelTable {
+public:
+    using Row = uint32_t;
+    static constexpr uint32_t no_owner = UINT32_MAX;
+
+    ChannelTable();
+
+    // Elements per leaf of the columns: 1 KiB of 32-bit values, long enough for
+    // scans to run over contiguous chunks, short enough that a write after a
+    // copy clones little.
+    static constexpr size_t column_leaf = 256;
+    using Column = PersistentVector<uint32_t, column_leaf>;
+
+    Row add(std::string_view name, uint32_t owner);
+    [[nodiscard]] size_t size() const { return ownerId.size(); }
+
+    void subscribe(Row row) { subscriberCounters.increment(row); }
+    // Does nothing if the channel has no subscribers, however many threads race on it.
+    void unsubscribe(Row row) { subscriberCounters.decrement(row); }
+    void publishVideo(Row row, const std::string& title);
+
+    [[nodiscard]] std::string_view name(Row row) const {
+        if (row < mapped.rows)
+            return mapped.text(mapped.names, mapped.nameOffsets, row);
+        return StringInterner::global().view(nameSymbol[row - mapped.rows]);
+    }
+    // Exact: a count the row held at one moment, even while other threads update it.
+    [[nodiscard]] uint64_t subscribers(Row row) const { return subscriberCounters.exact(row); }
+    // One load from the snapshot; as old as the last refresh.
+    [[nodiscard]] uint32_t approximateSubscribers(Row row) const { return subscriberSnapshot[row]; }
+    [[nodiscard]] uint32_t owner(Row row) const { return ownerId[row]; }
+    [[nodiscard]] uint32_t videos(Row row) const { return videoCount[row]; }
+    [[nodiscard]] std::string_view videoTitle(Row row, uint32_t video) const;
+
+    struct VideoRef {
+        Row channel;
+        uint32_t video;  // publication order within the channel
+    };
+    // Videos whose title contains every word of the query, in publication order.
+    [[nodiscard]] std::vector<VideoRef> searchVideos(std::string_view query, size_t limit = 100) const;
+    // Title words starting with prefix, most frequent first.
+    [[nodiscard]] std::vector<std::string_view> completeVideoTitle(std::string_view prefix) const {
+        return videoIndex.complete(prefix);
+    }
+
+    // Folds the live counters into the snapshot column that scans and approximate reads use.
+    void refreshSubscriberSnapshot();
+
+    // Whole columns, for scans; forEachChunk hands them out a leaf at a time.
+    [[nodiscard]] const Column& subscriberColumn() const { return subscriberSnapshot; }
+    [[nodiscard]] const Column& ownerColumn() const { return ownerId; }
+    [[nodiscard]] const Column& videoColumn() const { return videoCount; }
+
+    // Both scans read the snapshot.
+    [[nodiscard]] uint64_t totalSubscribers() const;
+    // Rows of the k channels with most subscribers, best first.
+    [[nodiscard]] std::vector<Row> topBySubscribers(size_t k) const;
+
+    // Names and titles are saved as text, since symbols are only meaningful within
+    // one process. Loading reads them, and the video documents, from the mapping
+    // in place, which the table keeps alive; only the numeric columns, the
+    // counters and the title index are copied out. Subscriber counts are saved exact.
+    void save(SnapshotWriter& out) const;
+    void load(std::shared_ptr<const Snapshot> in);
+
+private:
+    StripedCounters subscriberCounters;
+    Column subscriberSnapshot;
+    Column ownerId;
+    Column videoCount;
+    // Rows, names, titles and documents of a loaded snapshot, read in place.
+    struct Mapped {
+        std::shared_ptr<const Snapshot> snapshot;
+        Row rows = 0;
+        std::span<const uint64_t> nameOffsets;
+        std::string_view names;
+        std::span<const uint64_t> titleOffsets;  // per row: its first title in titleStarts
+        std::span<const uint64_t> titleStarts;
+        std::string_view titles;
+        std::span<const VideoRef> docs;
+
+        [[nodiscard]] static std::string_view text(std::string_view bytes, std::span<const uint64_t> offsets, size_t i) {
+            return bytes.substr(offsets[i], offsets[i + 1] - offsets[i]);
+        }
+    } mapped;
+    // Symbol columns from row mapped.rows on; videoDocs from document mapped.docs.size() on.
+    PersistentVector<StringInterner::Symbol, column_leaf> nameSymbol;
+    PersistentVector<std::vector<StringInterner::Symbol>> titles;
+    // Titles published on a mapped row since the load, by row. Few, so a copy
+    // of the table shares them whole until either side publishes on such a row.
+    CopyOnWrite<std::unordered_map<Row, std::vector<StringInterner::Symbol>>> laterTitles;
+    TitleIndex videoIndex;
+    PersistentVector<VideoRef> videoDocs;  // by TitleIndex document id
+};
+
+#endif //OOP_CHANNELTABLE_H
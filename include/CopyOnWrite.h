@@ -0,0 +1,46 @@
+#ifndef OOP_COPYONWRITE_H
+#define OOP_COPYONWRITE_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+// True if p is the only owner of its object, so writing to it cannot be seen
+// through any copy. The fence orders the write after everything the last other
+// owner did with the object before letting go of it.
+template<typename T>
+[[nodiscard]] bool soleOwner(const std::shared_ptr<T>& p) {
+    if (p.use_count() != 1)
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+// A value shared between copies until one of them writes to it. Copying bumps a
+// reference count; write() first clones the value if any other copy holds it.
+// Copies may live on other threads: a holder never changes a value it shares.
+template<typename T>
+class CopyOnWrite {
+public:
+    CopyOnWrite() : value(std::make_shared<T>()) {}
+    explicit CopyOnWrite(T initial) : value(std::make_shared<T>(std::move(initial))) {}
+    // no moves: a moved-from holder would have nothing to read
+    CopyOnWrite(const CopyOnWrite&) = default;
+    CopyOnWrite& operator=(const CopyOnWrite&) = default;
+
+    const T& operator*() const { return *value; }
+    const T* operator->() const { return value.get(); }
+    // True if a write would clone the value. Only a hint while copies live on other threads.
+    [[nodiscard]] bool shared() const { return value.use_count() != 1; }
+
+    T& write() {
+        if (!soleOwner(value))
+            value = std::make_shared<T>(std::as_const(*value));
+        return *value;
+    }
+
+private:
+    std::shared_ptr<T> value;
+};
+
+#endif //OOP_COPYONWRITE_H
@@ -0,0 +1,42 @@
+#ifndef OOP_LATENCYHISTOGRAM_H
+#define OOP_LATENCYHISTOGRAM_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Fixed-size log-linear histogram of durations in nanoseconds. Each power of two
+// is split into four buckets, so any reported percentile is within 25% of the
+// true value; recording is a couple of shifts and an increment, with no allocation.
+class LatencyHistogram {
+public:
+    static constexpr unsigned sub_bucket_bits = 2;
+    static constexpr size_t bucket_count = 64 << sub_bucket_bits;
+
+    void record(uint64_t ns);
+    void record(std::chrono::nanoseconds duration) { record(static_cast<uint64_t>(duration.count())); }
+    void merge(const LatencyHistogram& other);
+    void reset() { *this = LatencyHistogram(); }
+
+    [[nodiscard]] uint64_t count() const { return total; }
+    [[nodiscard]] uint64_t max() const { return largest; }
+    [[nodiscard]] double mean() const { return total ? static_cast<double>(sum) / static_cast<double>(total) : 0.0; }
+    // Upper bound of the bucket holding the p-th percentile, p in [0, 100].
+    [[nodiscard]] uint64_t percentile(double p) const;
+
+    // One line: count, mean, p50, p90, p99, max
+    friend std::ostream& operator<<(std::ostream& os, const LatencyHistogram& histogram);
+
+private:
+    std::array<uint64_t, bucket_count> buckets{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t largest = 0;
+
+    [[nodiscard]] static size_t bucketOf(uint64_t ns);
+    [[nodiscard]] static uint64_t upperBound(size_t bucket);
+};
+
+#endif //OOP_LATENCYHISTOGRAM_H
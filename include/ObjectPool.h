@@ -0,0 +1,126 @@
+#ifndef OOP_OBJECTPOOL_H
+#define OOP_OBJECTPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Slab allocator for objects of a single type. Objects are placed in fixed-size
+// slabs that never move, so both handles and addresses stay valid until the
+// object is destroyed. Freed slots are reused before a new slab is allocated.
+// Teardown releases whole slabs; only types with non-trivial destructors pay
+// for a pass over the live objects.
+template<typename T>
+class ObjectPool {
+public:
+    // Position of an object in the pool; 4 bytes instead of a pointer.
+    struct Handle {
+        static constexpr uint32_t invalid = UINT32_MAX;
+        uint32_t index = invalid;
+
+        [[nodiscard]] bool valid() const { return index != invalid; }
+        friend bool operator==(Handle a, Handle b) { return a.index == b.index; }
+    };
+
+    // 64 KiB of objects per slab, but never fewer than 64
+    static constexpr size_t slab_objects = sizeof(T) * 64 > 65536 ? 64 : 65536 / sizeof(T);
+
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+    ObjectPool(ObjectPool&& other) noexcept
+        : slabs(std::move(other.slabs)), live(std::move(other.live)), freeSlots(std::move(other.freeSlots)),
+          slots(std::exchange(other.slots, 0)) {}
+    ObjectPool& operator=(ObjectPool&& other) noexcept {
+        if (this != &other) {
+            clear();
+            slabs = std::move(other.slabs);
+            live = std::move(other.live);
+            freeSlots = std::move(other.freeSlots);
+            slots = std::exchange(other.slots, 0);
+        }
+        return *this;
+    }
+    ~ObjectPool() { clear(); }
+
+    template<typename... Args>
+    Handle create(Args&&... args) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            new (slot(index)) T(std::forward<Args>(args)...);
+            freeSlots.pop_back();
+        } else {
+            if (slots == slabs.size() * slab_objects)
+                slabs.push_back(std::make_unique_for_overwrite<Storage[]>(slab_objects));
+            index = static_cast<uint32_t>(slots);
+            new (slot(index)) T(std::forward<Args>(args)...);
+            ++slots;
+            live.push_back(false);
+        }
+        live[index] = true;
+        return Handle{index};
+    }
+
+    void destroy(Handle handle) {
+        if (!contains(handle))
+            throw std::out_of_range("Invalid pool handle");
+        get(handle).~T();
+        live[handle.index] = false;
+        freeSlots.push_back(handle.index);
+    }
+
+    [[nodiscard]] bool contains(Handle handle) const { return handle.index < slots && live[handle.index]; }
+
+    [[nodiscard]] T& get(Handle handle) { return *std::launder(reinterpret_cast<T*>(slot(handle.index))); }
+    [[nodiscard]] const T& get(Handle handle) const {
+        return *std::launder(reinterpret_cast<const T*>(slot(handle.index)));
+    }
+    T& operator[](Handle handle) { return get(handle); }
+    const T& operator[](Handle handle) const { return get(handle); }
+
+    // Makes room for n objects in total without further slab allocations.
+    void reserve(size_t n) {
+        slabs.reserve((n + slab_objects - 1) / slab_objects);
+        while (slabs.size() * slab_objects < n)
+            slabs.push_back(std::make_unique_for_overwrite<Storage[]>(slab_objects));
+        live.reserve(n);
+    }
+
+    [[nodiscard]] size_t size() const { return slots - freeSlots.size(); }
+    [[nodiscard]] size_t capacity() const { return slabs.size() * slab_objects; }
+
+    // Destroys every object and releases all slabs.
+    void clear() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < slots; i++)
+                if (live[i])
+                    get(Handle{static_cast<uint32_t>(i)}).~T();
+        }
+        slabs.clear();
+        live.clear();
+        freeSlots.clear();
+        slots = 0;
+    }
+
+private:
+    struct Storage {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Storage[]>> slabs;
+    std::vector<bool> live;
+    std::vector<uint32_t> freeSlots;
+    size_t slots = 0;  // slots handed out so far, live or freed
+
+    [[nodiscard]] unsigned char* slot(uint32_t index) const {
+        return slabs[index / slab_objects][index % slab_objects].bytes;
+    }
+};
+
+#endif //OOP_OBJECTPOOL_H
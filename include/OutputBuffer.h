@@ -0,0 +1,62 @@
+#ifndef OOP_OUTPUTBUFFER_H
+#define OOP_OUTPUTBUFFER_H
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Text output collected in a reusable buffer and handed to the stream with a
+// single write once it passes the flush threshold, on flush() and on
+// destruction. Integers are formatted with std::to_chars, without locales or
+// stream state, so rendering millions of rows costs little more than copying
+// their bytes.
+class OutputBuffer {
+public:
+    static constexpr size_t default_threshold = size_t{64} << 10;
+
+    explicit OutputBuffer(std::ostream& os, size_t flushThreshold = default_threshold);
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    ~OutputBuffer();
+
+    OutputBuffer& operator<<(std::string_view text) {
+        buffer.append(text);
+        return commit();
+    }
+
+    OutputBuffer& operator<<(const char* text) { return *this << std::string_view(text); }
+
+    OutputBuffer& operator<<(char c) {
+        buffer.push_back(c);
+        return commit();
+    }
+
+    template<std::integral T>
+        requires (!std::same_as<T, bool>)
+    OutputBuffer& operator<<(T value) {
+        char digits[24];
+        const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        buffer.append(digits, end);
+        return commit();
+    }
+
+    // Writes out whatever is buffered.
+    void flush();
+    [[nodiscard]] size_t pending() const { return buffer.size(); }
+
+private:
+    std::ostream& out;
+    std::string buffer;
+    size_t threshold;
+
+    OutputBuffer& commit() {
+        if (buffer.size() >= threshold)
+            flush();
+        return *this;
+    }
+};
+
+#endif //OOP_OUTPUTBUFFER_H
@@ -0,0 +1,105 @@
+#ifndef OOP_PASSWORDMANAGER_H
+#define OOP_PASSWORDMANAGER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <digestpp.hpp>
+
+class PasswordManager {
+public:
+    static constexpr size_t digest_size = 64;
+    static constexpr size_t salt_size = 16;
+
+    // credentials are kept as raw bytes, not hex, so they fit inline in User
+    using Digest = std::array<uint8_t, digest_size>;
+    using Salt = std::array<uint8_t, salt_size>;
+
+    // Safe to call from many threads; no two calls return the same salt.
+    static Salt make_salt() {
+        static std::atomic<uint64_t> next{1u};
+        const uint64_t nr = next.fetch_add(1, std::memory_order_relaxed);
+        Salt salt;
+        std::memcpy(salt.data(), &nr, sizeof(nr));
+        std::memcpy(salt.data() + sizeof(nr), &nr, sizeof(nr));
+        return salt;
+    }
+
+    static Digest hash_password(const std::string& plain, const Salt& salt) {
+        return digestpp::blake2b(512).set_salt(salt.data(), salt.size()).absorb(plain).digest<digest_size>();
+    }
+
+    // Recomputes the digest and compares it without early exit, so timing does not leak the match length.
+    [[nodiscard]] static bool verify_password(const std::string& plain, const Salt& salt, const Digest& expected) {
+        return digestpp::blake2b(512).set_salt(salt.data(), salt.size()).absorb(plain)
+            .digest_equals(expected.data(), expected.size());
+    }
+
+    // Hashes (password, salt) pairs in bulk; digest i is written to out[i].
+    // Work is split into contiguous ranges, one per worker thread, the calling
+    // thread included. workers == 0 means one per core, fewer for small batches.
+    static void hash_passwords(std::span<const std::pair<std::string, Salt>> credentials,
+                               std::span<Digest> out, size_t workers = 0) {
+        if (out.size() < credentials.size())
+            throw std::invalid_argument("Output buffer too small for password batch");
+        if (credentials.empty())
+            return;
+
+        if (workers == 0) {
+            // below this many credentials per thread, spawning costs more than it saves
+            constexpr size_t min_per_thread = 64;
+            workers = std::max(1u, std::thread::hardware_concurrency());
+            workers = std::min(workers, (credentials.size() + min_per_thread - 1) / min_per_thread);
+        }
+        workers = std::min(workers, credentials.size());
+        const size_t per_worker = (credentials.size() + workers - 1) / workers;
+        // rounding up can leave the last workers nothing to do
+        workers = (credentials.size() + per_worker - 1) / per_worker;
+
+        std::vector<std::exception_ptr> errors(workers);
+        auto work = [&](size_t w) {
+            try {
+                const size_t first = w * per_worker;
+                const size_t last = std::min(first + per_worker, credentials.size());
+                std::vector<const unsigned char*> data, salts;
+                std::vector<size_t> lengths;
+                data.reserve(last - first);
+                salts.reserve(last - first);
+                lengths.reserve(last - first);
+                for (size_t i = first; i < last; i++) {
+                    const auto& [plain, salt] = credentials[i];
+                    data.push_back(reinterpret_cast<const unsigned char*>(plain.data()));
+                    lengths.push_back(plain.size());
+                    salts.push_back(salt.data());
+                }
+                // each thread hashes its range several messages at a time, one per SIMD lane
+                digestpp::blake2b_multi(512, data.data(), lengths.data(), salts.data(),
+                                        out[first].data(), last - first);
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(workers - 1);
+            for (size_t w = 1; w < workers; w++)
+                threads.emplace_back(work, w);
+            work(0);
+        }
+        for (const auto& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+    }
+};
+
+#endif //OOP_PASSWORDMANAGER_H
@@ -0,0 +1,143 @@
+#ifndef OOP_PERSISTENTVECTOR_H
+#define OOP_PERSISTENTVECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <CopyOnWrite.h>
+
+// Vector with O(1) copies that share structure. Elements sit in leaves of
+// LeafSize under a tree of 32-way branches, so an access follows one pointer per
+// level: two levels cover 2^10 leaves, three 2^15. A write copies the nodes on
+// its path that another copy also holds, and changes the rest in place; a vector
+// that was never copied is therefore written like a plain one. Elements do not
+// move while their leaf is unshared, but a write after a copy may move the
+// elements of the leaves it clones.
+template<typename T, size_t LeafSize = 32>
+class PersistentVector {
+    static_assert(std::has_single_bit(LeafSize), "Leaf size must be a power of two");
+
+public:
+    PersistentVector() = default;
+    PersistentVector(size_t count, const T& value) {
+        for (size_t filled = 0; filled < count;) {
+            Leaf& leaf = leafFor(filled, true);
+            const size_t n = std::min(LeafSize - filled % LeafSize, count - filled);
+            std::fill_n(leaf.values.begin() + static_cast<std::ptrdiff_t>(filled % LeafSize), n, value);
+            filled += n;
+            length = filled;
+        }
+    }
+    explicit PersistentVector(std::span<const T> values) { append(values); }
+
+    [[nodiscard]] size_t size() const { return length; }
+    [[nodiscard]] bool empty() const { return length == 0; }
+
+    const T& operator[](size_t index) const {
+        const Node* node = root.get();
+        for (unsigned level = depth; level > 0; level--)
+            node = static_cast<const Branch*>(node)->children[childIndex(index, level)].get();
+        return static_cast<const Leaf*>(node)->values[index % LeafSize];
+    }
+
+    // The element, made safe to change: shared nodes on its path are copied first.
+    T& edit(size_t index) { return leafFor(index, false).values[index % LeafSize]; }
+
+    void push_back(const T& value) {
+        leafFor(length, true).values[length % LeafSize] = value;
+        ++length;
+    }
+
+    void append(std::span<const T> values) {
+        while (!values.empty()) {
+            Leaf& leaf = leafFor(length, true);
+            const size_t n = std::min(LeafSize - length % LeafSize, values.size());
+            std::copy_n(values.begin(), n, leaf.values.begin() + static_cast<std::ptrdiff_t>(length % LeafSize));
+            values = values.subspan(n);
+            length += n;
+        }
+    }
+
+    // Calls f(std::span<const T>) for each leaf's elements, in order.
+    template<typename F>
+    void forEachChunk(F f) const {
+        if (root)
+            visit(root.get(), depth, 0, f);
+    }
+
+    template<typename F>
+    void forEach(F f) const {
+        forEachChunk([&](std::span<const T> chunk) {
+            for (const T& value : chunk)
+                f(value);
+        });
+    }
+
+private:
+    static constexpr size_t width = 32;
+    static constexpr unsigned branch_bits = 5;
+    static constexpr unsigned leaf_bits = std::countr_zero(LeafSize);
+
+    // Nodes are told apart by their level, so they need no tag. Each is owned
+    // through a shared_ptr made for its own type, which destroys it correctly.
+    struct Node {};
+    struct Leaf : Node {
+        std::array<T, LeafSize> values{};
+    };
+    struct Branch : Node {
+        std::array<std::shared_ptr<Node>, width> children;
+    };
+
+    std::shared_ptr<Node> root;
+    size_t length = 0;
+    unsigned depth = 0;  // branch levels above the leaves
+
+    [[nodiscard]] static size_t childIndex(size_t index, unsigned level) {
+        return (index >> (leaf_bits + branch_bits * (level - 1))) & (width - 1);
+    }
+
+    [[nodiscard]] size_t capacity() const { return LeafSize << (branch_bits * depth); }
+
+    template<typename N>
+    static N& own(std::shared_ptr<Node>& node) {
+        if (!node)
+            node = std::make_shared<N>();
+        else if (!soleOwner(node))
+            node = std::make_shared<N>(static_cast<const N&>(*node));
+        return static_cast<N&>(*node);
+    }
+
+    // With grow set, index may be size(); missing nodes and levels are added.
+    Leaf& leafFor(size_t index, bool grow) {
+        if (grow && root && index >= capacity()) {
+            auto raised = std::make_shared<Branch>();
+            raised->children[0] = std::move(root);
+            root = std::move(raised);
+            ++depth;
+        }
+        std::shared_ptr<Node>* node = &root;
+        for (unsigned level = depth; level > 0; level--)
+            node = &own<Branch>(*node).children[childIndex(index, level)];
+        return own<Leaf>(*node);
+    }
+
+    template<typename F>
+    size_t visit(const Node* node, unsigned level, size_t first, F& f) const {
+        if (level == 0) {
+            const size_t n = std::min(LeafSize, length - first);
+            f(std::span<const T>(static_cast<const Leaf*>(node)->values.data(), n));
+            return first + n;
+        }
+        for (const auto& child : static_cast<const Branch*>(node)->children) {
+            if (!child || first >= length)
+                break;
+            first = visit(child.get(), level - 1, first, f);
+        }
+        return first;
+    }
+};
+
+#endif //OOP_PERSISTENTVECTOR_H
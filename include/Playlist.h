@@ -0,0 +1,60 @@
+#ifndef OOP_PLAYLIST_H
+#define OOP_PLAYLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Ordered list of distinct song ids. Song ids are small dense integers handed
+// out by the owning channel, so membership is one load from a table indexed by
+// id. The order is kept in chunks of at most chunk_capacity ids; inserting,
+// removing or moving an entry shifts ids inside one chunk and walks the short
+// list of chunk sizes, never the whole playlist.
+class Playlist {
+public:
+    using SongId = uint32_t;
+    static constexpr size_t npos = SIZE_MAX;
+
+    // Inserts id before the entry at position (at the end if position >= size()).
+    // Returns false and leaves the playlist unchanged if id is already in it.
+    bool insert(size_t position, SongId id);
+    bool push_back(SongId id) { return insert(count, id); }
+    bool erase(SongId id);
+    // Moves id so that it ends up at position (the last one if position >= size()).
+    bool move(SongId id, size_t position);
+
+    [[nodiscard]] bool contains(SongId id) const { return id < chunkOf.size() && chunkOf[id] != no_chunk; }
+    // Position of id, or npos.
+    [[nodiscard]] size_t position(SongId id) const;
+    [[nodiscard]] SongId at(size_t position) const;
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+    // Bytes held by the playlist, including unused capacity.
+    [[nodiscard]] size_t memoryUsage() const;
+
+    // Calls f(SongId) for every entry in order.
+    template<typename F>
+    void forEach(F f) const {
+        for (uint32_t chunk : order)
+            for (SongId id : chunks[chunk])
+                f(id);
+    }
+
+private:
+    static constexpr size_t chunk_capacity = 512;
+    static constexpr uint32_t no_chunk = UINT32_MAX;
+
+    std::vector<std::vector<SongId>> chunks;  // storage; slots are reused through freeChunks
+    std::vector<uint32_t> order;              // chunk slots in playlist order
+    std::vector<uint32_t> freeChunks;
+    std::vector<uint32_t> chunkOf;            // by song id: slot of the chunk holding it
+    size_t count = 0;
+
+    // Index into order of the chunk holding position, and the position within that chunk.
+    [[nodiscard]] std::pair<size_t, size_t> locate(size_t position) const;
+    uint32_t newChunk();
+    void releaseChunk(size_t orderIndex);
+};
+
+#endif //OOP_PLAYLIST_H
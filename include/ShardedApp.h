@@ -0,0 +1,89 @@
+#ifndef OOP_SHARDEDAPP_H
+#define OOP_SHARDEDAPP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ChannelTable.h>
+#include <ObjectPool.h>
+#include <PasswordManager.h>
+#include <SubscriptionGraph.h>
+#include <User.h>
+#include <UserIndex.h>
+
+// Users and channels split over shards, each behind a reader-writer lock of its
+// own, for serving from many threads at once. A user lives in the shard picked
+// by the hash of its name and a channel in the one picked by the hash of its
+// name; ids encode the shard, so any id leads straight to it. Readers of a
+// shard share its lock and only wait for writers to that same shard.
+//
+// Only a subscription holds two shard locks, taken in shard order: it is
+// recorded in the subscriber's shard under its exclusive lock and counted in
+// the channel's shard, whose counters are safe to bump under a shared lock.
+class ShardedApp {
+public:
+    using UserId = uint32_t;
+    using ChannelId = uint32_t;
+    static constexpr uint32_t none = UINT32_MAX;
+
+    explicit ShardedApp(size_t shardCount = 16);
+
+    // none if the name is empty or taken. The password is hashed before any lock is taken.
+    UserId addUser(std::string_view username, const std::string& password);
+    UserId addUser(std::string_view username, const PasswordManager::Digest& digest, const PasswordManager::Salt& salt);
+    // The stored salt and digest are copied under a shared lock and the hash runs unlocked.
+    [[nodiscard]] bool login(std::string_view username, const std::string& password) const;
+    [[nodiscard]] UserId findUser(std::string_view username) const;
+    // A copy, since the shard may change once its lock is released.
+    [[nodiscard]] std::optional<User> getUser(UserId id) const;
+
+    // none if there is no such owner.
+    ChannelId addChannel(std::string_view channelName, std::string_view ownerName);
+    bool publishVideo(ChannelId channel, const std::string& title);
+    [[nodiscard]] std::string channelName(ChannelId channel) const;
+    [[nodiscard]] uint64_t subscribers(ChannelId channel) const;
+
+    // False for unknown accounts or channels and for repeated (un)subscribes.
+    bool subscribe(std::string_view username, ChannelId channel);
+    bool unsubscribe(std::string_view username, ChannelId channel);
+    [[nodiscard]] bool isSubscribed(std::string_view username, ChannelId channel) const;
+
+    // Asks every shard in turn; titles are grouped by shard, oldest first within one.
+    [[nodiscard]] std::vector<std::string_view> searchVideos(std::string_view query, size_t limit = 100) const;
+
+    [[nodiscard]] size_t shardCount() const { return shards.size(); }
+    [[nodiscard]] size_t userCount() const;
+    [[nodiscard]] size_t channelCount() const;
+
+private:
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        ObjectPool<User> userPool;
+        std::vector<ObjectPool<User>::Handle> users;
+        UserIndex userIndex;  // name -> position in users
+        ChannelTable channels;  // owners are UserIds
+        // position in users -> ChannelId, for this shard's users
+        SubscriptionGraph subscriptions;
+        // rows of channels, readable without the lock to validate ids from other shards
+        std::atomic<uint32_t> channelRows{0};
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    [[nodiscard]] size_t shardOf(std::string_view name) const;
+    [[nodiscard]] uint32_t globalId(uint32_t local, size_t shard) const {
+        return static_cast<uint32_t>(local * shards.size() + shard);
+    }
+    [[nodiscard]] size_t shardOfId(uint32_t id) const { return id % shards.size(); }
+    [[nodiscard]] uint32_t localId(uint32_t id) const { return static_cast<uint32_t>(id / shards.size()); }
+    [[nodiscard]] bool validChannel(ChannelId channel) const;
+    bool changeSubscription(std::string_view username, ChannelId channel, bool subscribe);
+};
+
+#endif //OOP_SHARDEDAPP_H
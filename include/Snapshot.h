@@ -0,0 +1,166 @@
+#ifndef OOP_SNAPSHOT_H
+#define OOP_SNAPSHOT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Sections of an App or MusicChannel snapshot. Each component saves and loads its own.
+enum class SnapshotSection : uint32_t {
+    user_digests = 1,
+    user_salts,
+    user_name_offsets,
+    user_name_bytes,
+    user_index_slots,
+    user_index_keys,
+    user_index_meta,
+    channel_owners,
+    channel_subscribers,
+    channel_videos,
+    channel_name_offsets,
+    channel_name_bytes,
+    video_title_offsets,  // per channel: its first title in video_title_starts
+    video_title_starts,   // per title: its first byte in video_title_bytes
+    video_title_bytes,
+    video_docs,
+    title_index_nodes,
+    title_index_child_offsets,
+    title_index_children,
+    title_index_postings,
+    title_index_posting_bytes,
+    title_index_skips,
+    title_index_word_offsets,
+    title_index_word_bytes,
+    title_index_meta,
+    subscription_user_offsets,
+    subscription_user_targets,
+    subscription_channel_offsets,
+    subscription_channel_targets,
+    log_position,  // the last write-ahead log record the snapshot reflects
+    music_label,
+    song_title_offsets,  // by song id: its first byte in song_title_bytes
+    song_title_bytes,
+    songs,  // song ids in the order the songs were added
+    playlist_songs,
+    favorite_songs,
+};
+
+// File layout: a 64-byte header, the sections one after another, each padded to
+// a 64-byte boundary, then a table with one entry per section. Sections hold
+// arrays of fixed-width values in host byte order (the header records which),
+// so a reader maps the file and uses them in place. Each section has a
+// BLAKE2b-256 tree checksum: 1 MiB leaves are hashed several at a time with
+// blake2b_multi and the leaf digests are hashed again. The table has a checksum
+// of its own, stored in the header.
+namespace snapshot_format {
+    inline constexpr std::array<char, 8> magic{'O', 'O', 'P', 'S', 'N', 'A', 'P', '\0'};
+    inline constexpr uint32_t version = 1;
+    inline constexpr uint32_t byte_order = 0x01020304;
+    inline constexpr size_t alignment = 64;
+
+    using Checksum = std::array<uint8_t, 32>;
+
+    struct Header {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t sectionCount;
+        uint64_t tableOffset;
+        Checksum tableChecksum;
+    };
+
+    struct Entry {
+        uint32_t id;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+        Checksum checksum;
+        uint64_t padding;
+    };
+
+    static_assert(sizeof(Header) == 64 && sizeof(Entry) == 64);
+
+    [[nodiscard]] Checksum checksum(const void* data, size_t size);
+}
+
+// Writes a snapshot to a temporary file next to the target and renames it over
+// the target in commit(), after flushing it to disk, so an existing snapshot is
+// replaced only by a complete one.
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::filesystem::path path);
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+    // Deletes the temporary file unless commit() succeeded.
+    ~SnapshotWriter();
+
+    template<typename T>
+    void add(SnapshotSection id, std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>, "Snapshot sections hold plain values");
+        write(id, values.data(), values.size_bytes());
+    }
+    template<typename T>
+    void add(SnapshotSection id, const std::vector<T>& values) { add(id, std::span<const T>(values)); }
+    void add(SnapshotSection id, std::string_view bytes) { write(id, bytes.data(), bytes.size()); }
+
+    void commit();
+
+private:
+    std::filesystem::path target;
+    std::filesystem::path temporary;
+    std::ofstream file;
+    uint64_t offset;
+    std::vector<snapshot_format::Entry> entries;
+    bool committed = false;
+
+    void write(SnapshotSection id, const void* data, size_t size);
+    void pad();
+};
+
+// A snapshot file mapped read-only. Opening checks the header and the section
+// table; verify() checks every section against its checksum. Sections are
+// handed out as spans into the mapping and stay valid while the Snapshot lives.
+class Snapshot {
+public:
+    explicit Snapshot(const std::filesystem::path& path);
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    ~Snapshot();
+
+    // Throws std::runtime_error naming the first damaged section.
+    void verify() const;
+
+    [[nodiscard]] bool has(SnapshotSection id) const { return find(id) != nullptr; }
+    [[nodiscard]] std::string_view bytes(SnapshotSection id) const;
+    template<typename T>
+    [[nodiscard]] std::span<const T> section(SnapshotSection id) const {
+        static_assert(std::is_trivially_copyable_v<T>, "Snapshot sections hold plain values");
+        const std::string_view raw = bytes(id);
+        if (raw.size() % sizeof(T) != 0)
+            throw std::runtime_error("Snapshot section has the wrong element size");
+        // opening rejects sections that do not start on a 64-byte boundary of the page-aligned mapping
+        return {reinterpret_cast<const T*>(raw.data()), raw.size() / sizeof(T)};
+    }
+    [[nodiscard]] size_t size() const { return length; }
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    std::span<const snapshot_format::Entry> entries;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+    [[nodiscard]] const snapshot_format::Entry* find(SnapshotSection id) const;
+    void unmap();
+};
+
+#endif //OOP_SNAPSHOT_H
@@ -0,0 +1,89 @@
+#ifndef OOP_STRINGINTERNER_H
+#define OOP_STRINGINTERNER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+// Process-wide table of distinct strings. Each string is stored once, in
+// 64 KiB arena blocks that are never moved or freed, and is named by a 32-bit
+// symbol that encodes its block and offset. Turning a symbol back into text is
+// two loads and takes no lock; the returned view stays valid for the life of
+// the process. Interning looks the text up in one of several hash shards,
+// each behind its own lock, so threads interning different strings rarely
+// contend.
+class StringInterner {
+public:
+    using Symbol = uint32_t;
+    // Symbol of the empty string, and the value of a default-constructed symbol.
+    static constexpr Symbol empty = 0;
+    static constexpr Symbol none = UINT32_MAX;
+
+    StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    static StringInterner& global();
+
+    // Symbol of text, storing it if it is new. Safe to call from any thread.
+    Symbol intern(std::string_view text);
+    // Symbol of text if it has been interned, otherwise none. Never stores anything.
+    [[nodiscard]] Symbol find(std::string_view text) const;
+
+    [[nodiscard]] std::string_view view(Symbol symbol) const {
+        const char* block = blocks[symbol >> offset_bits].load(std::memory_order_acquire);
+        const char* entry = block + (symbol & offset_mask);
+        uint32_t length;
+        std::memcpy(&length, entry, sizeof(length));
+        return {entry + sizeof(length), length};
+    }
+
+    // Sizes the hash shards for about count more strings, so bulk loads do not rehash.
+    void reserve(size_t count);
+
+    [[nodiscard]] size_t size() const;
+    // Arena bytes in use, including the length prefixes.
+    [[nodiscard]] size_t bytes() const;
+
+private:
+    static constexpr unsigned offset_bits = 16;
+    static constexpr uint32_t offset_mask = (uint32_t{1} << offset_bits) - 1;
+    static constexpr size_t block_size = size_t{1} << offset_bits;
+    static constexpr size_t max_blocks = size_t{1} << (32 - offset_bits);
+    static constexpr size_t shard_count = 16;
+
+    struct Slot {
+        uint32_t hash;
+        Symbol symbol;  // none when empty
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::vector<Slot> slots;  // open addressing, linear probing, power-of-two size
+        size_t count = 0;
+    };
+
+    // Written once per block under arenaMutex; read without locking by view.
+    std::unique_ptr<std::atomic<const char*>[]> blocks;
+    std::vector<std::unique_ptr<char[]>> storage;
+    mutable std::mutex arenaMutex;
+    size_t currentBlock = 0;
+    size_t used = block_size;  // bytes taken in the current block
+    size_t arenaBytes = 0;
+    std::array<Shard, shard_count> shards;
+
+    [[nodiscard]] static uint64_t hash(std::string_view text);
+    // Index of the slot holding text, or of the empty slot where it would go.
+    [[nodiscard]] size_t probe(const Shard& shard, uint32_t h, std::string_view text) const;
+    Symbol store(std::string_view text);
+    static void grow(Shard& shard, size_t capacity);
+};
+
+#endif //OOP_STRINGINTERNER_H
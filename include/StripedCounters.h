@@ -0,0 +1,79 @@
+#ifndef OOP_STRIPEDCOUNTERS_H
+#define OOP_STRIPEDCOUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <PersistentVector.h>
+
+// One non-negative counter per row, split over shard_count stripes. Each thread
+// updates its own stripe, and every stripe of a block of rows is a separate
+// cache-line-aligned array, so threads hammering the same row never write to
+// the same cache line. increment, decrement and the reads may run on any
+// number of threads; resize, assign and copying need exclusive access.
+//
+// A cell keeps its count in the low 32 bits and a change count in the high 32,
+// bumped by every update, so decrement can tell that a stripe it read as zero
+// has not changed since, even if it went up and came back down.
+//
+// Blocks of block_rows rows sit in a PersistentVector, so a copy is O(1) and
+// shares them; the first update to a shared block clones that block alone. An
+// update that clones is not safe alongside other updates, so while a copy
+// shares blocks, updates need exclusive access too, as App's always have.
+// Counters that were never copied, like ShardedApp's, never clone.
+class StripedCounters {
+public:
+    static constexpr size_t shard_count = 16;
+    static constexpr size_t block_rows = 8;
+
+    void resize(size_t rows);
+    [[nodiscard]] size_t size() const { return rowCount; }
+
+    void increment(size_t row) { cell(block(row), threadShard(), row).fetch_add(version_step + 1, std::memory_order_relaxed); }
+    // Takes one from the row, preferring the caller's stripe. Stripes never go
+    // below zero, so the total clamps at zero. Returns false only when every
+    // stripe was zero at one moment during the call.
+    bool decrement(size_t row);
+    // Sum of all stripes, linearizable: the count the row held at one moment
+    // during the call. Retries while writers keep changing the row, so it can
+    // take longer under a storm of updates to the same row.
+    [[nodiscard]] uint64_t exact(size_t row) const;
+    // Replaces the row's count, clamped to what the stripes can hold. Needs
+    // exclusive access, like resize.
+    void assign(size_t row, uint64_t value);
+
+private:
+    static constexpr size_t per_line = 64 / sizeof(std::atomic<uint64_t>);
+    static constexpr size_t block_lines = block_rows / per_line;
+    static constexpr uint64_t version_step = uint64_t{1} << 32;
+    static constexpr uint64_t count_mask = version_step - 1;
+
+    struct alignas(64) Line {
+        std::array<std::atomic<uint64_t>, per_line> counts{};
+    };
+
+    // Atomics cannot be copied, so cloning a block loads and stores each cell.
+    struct Block {
+        std::array<std::array<Line, block_lines>, shard_count> stripes;
+
+        Block() = default;
+        Block(const Block& other) { *this = other; }
+        Block& operator=(const Block& other);
+    };
+
+    PersistentVector<Block, 1> blocks;
+    size_t rowCount = 0;
+
+    [[nodiscard]] Block& block(size_t row) { return blocks.edit(row / block_rows); }
+    [[nodiscard]] const Block& block(size_t row) const { return blocks[row / block_rows]; }
+    [[nodiscard]] static std::atomic<uint64_t>& cell(Block& block, size_t shard, size_t row) {
+        return block.stripes[shard][row % block_rows / per_line].counts[row % per_line];
+    }
+    [[nodiscard]] static const std::atomic<uint64_t>& cell(const Block& block, size_t shard, size_t row) {
+        return block.stripes[shard][row % block_rows / per_line].counts[row % per_line];
+    }
+    [[nodiscard]] static size_t threadShard();
+};
+
+#endif //OOP_STRIPEDCOUNTERS_H
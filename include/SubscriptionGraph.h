@@ -0,0 +1,137 @@
+#ifndef OOP_SUBSCRIPTIONGRAPH_H
+#define OOP_SUBSCRIPTIONGRAPH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <CopyOnWrite.h>
+
+class Snapshot;
+class SnapshotWriter;
+
+// Who subscribes to what, in both directions. The bulk of the edges lives in
+// two CSR snapshots (user -> channels and channel -> users): one offset per node
+// and one 4-byte id per edge, sorted within each node. Recent edits go to a
+// delta that records only edges whose state differs from the snapshots; once
+// the delta grows past a fraction of the graph it is merged into new snapshots.
+// Snapshots never change once built, so copies of the graph share them, and
+// share the delta until either copy records an edit. A large shared delta is
+// merged into new snapshots then rather than cloned.
+class SubscriptionGraph {
+public:
+    using UserId = uint32_t;
+    using ChannelId = uint32_t;
+
+    // Both return false when the edge is already in the requested state.
+    bool subscribe(UserId user, ChannelId channel);
+    bool unsubscribe(UserId user, ChannelId channel);
+
+    // One hash probe into the delta, then a binary search in the shorter of the two adjacency lists.
+    [[nodiscard]] bool isSubscribed(UserId user, ChannelId channel) const;
+
+    // Calls f(ChannelId) for every channel the user follows.
+    template<typename F>
+    void forEachSubscription(UserId user, F f) const { forEach(*byUser, pending->userEdits, user, true, f); }
+    // Calls f(UserId) for every subscriber of the channel.
+    template<typename F>
+    void forEachSubscriber(ChannelId channel, F f) const { forEach(*byChannel, pending->channelEdits, channel, false, f); }
+
+    [[nodiscard]] size_t subscriptionCount(UserId user) const;
+    [[nodiscard]] size_t subscriberCount(ChannelId channel) const;
+    [[nodiscard]] size_t edgeCount() const { return edges; }
+    [[nodiscard]] size_t pendingEdits() const { return pending->delta.size(); }
+
+    // Merges the delta into fresh snapshots.
+    void compact();
+
+    // Saves both directions as CSR arrays, with pending edits merged in; loading
+    // replaces the graph with one that reads the arrays from the mapping in
+    // place, and leaves no pending edits. load throws
+    // std::runtime_error unless every id is below users or channels and every
+    // adjacency list is strictly ascending.
+    void save(SnapshotWriter& out) const;
+    void load(const std::shared_ptr<const Snapshot>& in, size_t users, size_t channels);
+
+private:
+    // Read through offsets and targets, which view either the vectors the Csr
+    // was built in or the sections of a loaded snapshot, kept mapped while the
+    // Csr lives. A built Csr is never copied or moved, so the views stay valid.
+    struct Csr {
+        std::vector<uint64_t> ownOffsets{0};
+        std::vector<uint32_t> ownTargets;
+        std::shared_ptr<const Snapshot> mapping;
+        std::span<const uint64_t> offsets = ownOffsets;
+        std::span<const uint32_t> targets = ownTargets;
+
+        Csr() = default;
+        Csr(const Csr&) = delete;
+        Csr& operator=(const Csr&) = delete;
+
+        [[nodiscard]] size_t nodes() const { return offsets.size() - 1; }
+        [[nodiscard]] std::span<const uint32_t> row(uint32_t node) const {
+            if (node >= nodes())
+                return {};
+            return {targets.data() + offsets[node], static_cast<size_t>(offsets[node + 1] - offsets[node])};
+        }
+        [[nodiscard]] bool contains(uint32_t node, uint32_t target) const;
+    };
+
+    // Edges not yet merged: key (user << 32 | channel) -> whether the edge now exists.
+    using Delta = std::unordered_map<uint64_t, bool>;
+    // Per node, the other endpoints of its delta edges.
+    using Edits = std::unordered_map<uint32_t, std::vector<uint32_t>>;
+
+    static constexpr size_t min_compaction = 4096;
+    static constexpr size_t short_row = 64;
+
+    struct Pending {
+        Delta delta;
+        Edits userEdits;
+        Edits channelEdits;
+    };
+
+    std::shared_ptr<const Csr> byUser = std::make_shared<const Csr>();
+    std::shared_ptr<const Csr> byChannel = std::make_shared<const Csr>();
+    CopyOnWrite<Pending> pending;
+    size_t edges = 0;
+
+    [[nodiscard]] static uint64_t key(UserId user, ChannelId channel) {
+        return (static_cast<uint64_t>(user) << 32) | channel;
+    }
+    [[nodiscard]] bool inSnapshot(UserId user, ChannelId channel) const;
+    void record(UserId user, ChannelId channel, bool present);
+    [[nodiscard]] size_t degree(const Csr& csr, const Edits& edits, uint32_t node, bool fromUser) const;
+    // Sorted targets of a node's edits that are new to, or deleted from, its snapshot row.
+    void split(const std::vector<uint32_t>& edited, uint32_t node, bool fromUser, std::span<const uint32_t> row,
+               std::vector<uint32_t>& added, std::vector<uint32_t>& removed) const;
+    [[nodiscard]] std::shared_ptr<const Csr> merge(const Csr& csr, const Edits& edits, bool fromUser) const;
+
+    template<typename F>
+    void forEach(const Csr& csr, const Edits& edits, uint32_t node, bool fromUser, F& f) const {
+        const auto edited = edits.find(node);
+        if (edited == edits.end()) {
+            for (uint32_t target : csr.row(node))
+                f(target);
+            return;
+        }
+        // a node with pending edits: walk the snapshot row skipping removed edges, then report the additions
+        std::vector<uint32_t> added, removed;
+        split(edited->second, node, fromUser, csr.row(node), added, removed);
+        auto skip = removed.begin();
+        for (uint32_t target : csr.row(node)) {
+            if (skip != removed.end() && *skip == target) {
+                ++skip;
+                continue;
+            }
+            f(target);
+        }
+        for (uint32_t target : added)
+            f(target);
+    }
+};
+
+#endif //OOP_SUBSCRIPTIONGRAPH_H
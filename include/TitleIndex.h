@@ -0,0 +1,137 @@
+#ifndef OOP_TITLEINDEX_H
+#define OOP_TITLEINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <CopyOnWrite.h>
+#include <PersistentVector.h>
+
+class Snapshot;
+class SnapshotWriter;
+
+// Word search over titles, updated as titles are added. Each title gets the
+// next document id. Every word maps to a posting list of those ids, stored as
+// varint gaps with a skip entry every skip_interval postings, so intersecting
+// a rare word with a common one jumps over most of the common list.
+// Words live in a byte trie; every trie node caches the most frequent words
+// below it, so completing a prefix is a walk down the trie and a copy. A hash
+// map from word to trie node keeps indexing from walking the trie for words it
+// has already seen.
+class TitleIndex {
+public:
+    using DocId = uint32_t;
+    static constexpr size_t max_suggestions = 8;
+
+    TitleIndex();
+
+    DocId add(std::string_view title);
+    [[nodiscard]] size_t size() const { return documents; }
+    [[nodiscard]] size_t words() const { return postings.size(); }
+
+    // Titles containing every word of the query, oldest first, at most limit of them.
+    [[nodiscard]] std::vector<DocId> search(std::string_view query, size_t limit = 100) const;
+    // Indexed words starting with prefix, most frequent first.
+    [[nodiscard]] std::vector<std::string_view> complete(std::string_view prefix, size_t limit = max_suggestions) const;
+
+    // The trie, word list and posting lists are saved as flat arrays; loading
+    // copies them back and rebuilds only the word -> node map. load decodes
+    // every posting list and checks every node, word and document id, and
+    // throws std::runtime_error on the first that is out of range.
+    void save(SnapshotWriter& out) const;
+    void load(const Snapshot& in);
+
+    // Lower-cased words of text, split at ASCII spaces and punctuation. Bytes
+    // above 0x7f are kept, so UTF-8 words stay whole.
+    template<typename F>
+    static void forEachWord(std::string_view text, F f) {
+        std::string word;
+        for (char c : text) {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte >= 0x80 || (byte >= '0' && byte <= '9') || (byte >= 'a' && byte <= 'z')) {
+                word += c;
+            } else if (byte >= 'A' && byte <= 'Z') {
+                word += static_cast<char>(byte - 'A' + 'a');
+            } else if (!word.empty()) {
+                f(std::string_view(word));
+                word.clear();
+            }
+        }
+        if (!word.empty())
+            f(std::string_view(word));
+    }
+
+private:
+    static constexpr uint32_t skip_interval = 64;
+    static constexpr uint32_t no_word = UINT32_MAX;
+
+    struct Skip {
+        DocId last;      // document id just before the block
+        uint32_t offset; // byte offset of the block
+        uint32_t index;  // number of postings before the block
+    };
+
+    struct Postings {
+        std::vector<uint8_t> bytes;
+        std::vector<Skip> skips;
+        DocId last = 0;
+        uint32_t count = 0;
+
+        void append(DocId doc);
+    };
+
+    // Forward iterator over one posting list with skip-assisted seek.
+    class Cursor {
+    public:
+        explicit Cursor(const Postings& list) : postings(&list) {}
+        // Advances to the first posting >= target; false when the list is exhausted.
+        bool seek(DocId target);
+        bool next();
+        [[nodiscard]] DocId doc() const { return current; }
+    private:
+        const Postings* postings;
+        uint32_t offset = 0;
+        uint32_t index = 0;
+        DocId current = 0;
+    };
+
+    struct TrieNode {
+        std::vector<std::pair<char, uint32_t>> children;  // sorted by byte
+        uint32_t parent = 0;
+        uint32_t word = no_word;                          // id of the word ending here
+        uint8_t topCount = 0;
+        std::array<uint32_t, max_suggestions> top{};      // most frequent words below, best first
+    };
+
+    struct WordHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view word) const { return std::hash<std::string_view>{}(word); }
+    };
+
+    using WordNodes = std::unordered_map<std::string, uint32_t, WordHash, std::equal_to<>>;
+
+    // Copies of the index share the trie and the posting lists a leaf at a
+    // time, and the vocabulary until either copy learns a new word.
+    PersistentVector<TrieNode, 32> trie;
+    CopyOnWrite<WordNodes> wordNodes;
+    PersistentVector<Postings, 8> postings;  // by word id
+    CopyOnWrite<std::vector<uint32_t>> wordOffset; // word id's text is wordText[wordOffset[id], wordOffset[id + 1])
+    CopyOnWrite<std::string> wordText;
+    DocId documents = 0;
+
+    [[nodiscard]] static bool wellFormed(const Postings& list, DocId documents);
+    [[nodiscard]] uint32_t findNode(std::string_view prefix) const;
+    // Trie node of the word, created if it is new.
+    uint32_t insertWord(std::string_view word);
+    void promote(uint32_t node, uint32_t id);
+    [[nodiscard]] std::string_view wordOf(uint32_t id) const {
+        return {wordText->data() + (*wordOffset)[id], (*wordOffset)[id + 1] - (*wordOffset)[id]};
+    }
+};
+
+#endif //OOP_TITLEINDEX_H
@@ -0,0 +1,46 @@
+#ifndef OOP_USER_H
+#define OOP_USER_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <OutputBuffer.h>
+#include <PasswordManager.h>
+#include <StringInterner.h>
+
+class User {
+private:
+    PasswordManager::Digest password{};
+    PasswordManager::Salt salt{};
+protected:
+    StringInterner::Symbol username = StringInterner::empty;
+public:
+    User() = default;
+    explicit User(std::string_view usern) : username(StringInterner::global().intern(usern)) {}
+    User(const PasswordManager::Digest& pass, std::string_view usern, const PasswordManager::Salt& sare) : password(pass), salt(sare) ,username(StringInterner::global().intern(usern)){}
+    User(const User& other) = default;
+    User& operator=(const User& other) = default;
+    virtual ~User() = default;
+
+    friend std::ostream& operator<<(std::ostream& os, const User& user) {
+        os << "Username: " << user.getUsername();
+        return os;
+    }
+
+    friend OutputBuffer& operator<<(OutputBuffer& out, const User& user) {
+        return out << "Username: " << user.getUsername();
+    }
+
+    [[nodiscard]] std::string_view getUsername() const { return StringInterner::global().view(username); }
+    [[nodiscard]] const PasswordManager::Salt& getSalt() const { return salt; }
+    [[nodiscard]] const PasswordManager::Digest& getDigest() const { return password; }
+    [[nodiscard]] bool matchesDigest(const PasswordManager::Digest& digest) const {
+        return digestpp::detail::constant_time_equal(password.data(), digest.data(), password.size());
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool CheckLogin(const std::string& username_, const std::string& _password)const{
+        return getUsername()==username_ && PasswordManager::verify_password(_password, salt, password);
+    }
+};
+
+#endif //OOP_USER_H
@@ -0,0 +1,79 @@
+#ifndef OOP_USERINDEX_H
+#define OOP_USERINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <CopyOnWrite.h>
+#include <PersistentVector.h>
+
+class Snapshot;
+class SnapshotWriter;
+
+// Open-addressing map from username to the user's position in App's table.
+// Slots are 32 bytes, two per cache line, and keep the full hash so a probe
+// compares one word before it touches any key bytes. Names of up to 16 bytes
+// live inside the slot; longer ones go to a shared pool.
+//
+// Copies share the slot array, a leaf of 2048 slots at a time, and the pool; a
+// write to a copy clones only the leaf it lands in.
+//
+// An index loaded from a snapshot probes the saved slot array in place and
+// keeps names inserted since in a table of its own; find looks in the saved
+// slots first. Names are never removed, so each is in exactly one of the two.
+class UserIndex {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    UserIndex();
+
+    // Returns false and leaves the index unchanged if the name is already present.
+    bool insert(std::string_view name, uint32_t value);
+    [[nodiscard]] uint32_t find(std::string_view name) const;
+    [[nodiscard]] bool contains(std::string_view name) const { return find(name) != npos; }
+    void reserve(size_t n);
+    [[nodiscard]] size_t size() const { return mappedCount + count; }
+
+    [[nodiscard]] static uint64_t hash(std::string_view name);
+
+    // The slot array and key pool are saved as they are, merged with the names
+    // inserted since a load, so loading rebuilds nothing: the index reads them
+    // from the mapping, which it keeps alive. load checks that every value is
+    // below values and every key lies inside the pool, and throws
+    // std::runtime_error otherwise.
+    void save(SnapshotWriter& out) const;
+    void load(std::shared_ptr<const Snapshot> in, size_t values);
+
+private:
+    static constexpr size_t inline_key_size = 16;
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t value;  // npos marks an empty slot
+        uint32_t length;
+        char key[inline_key_size];  // the name itself, or its offset in keyPool when it does not fit
+    };
+
+    PersistentVector<Slot, 2048> slots;
+    CopyOnWrite<std::string> keyPool;
+    size_t mask;
+    size_t count;
+    std::shared_ptr<const Snapshot> mapping;
+    std::span<const Slot> mappedSlots;
+    std::string_view mappedKeys;
+    size_t mappedCount = 0;
+
+    [[nodiscard]] static std::string_view keyOf(const Slot& slot, std::string_view pool);
+    // Value stored for name in one slot array, or npos; mask is its size less one.
+    template<typename Slots>
+    [[nodiscard]] static uint32_t probe(const Slots& table, size_t mask, std::string_view pool, uint64_t h,
+                                        std::string_view name);
+    void grow();
+    void rehash(size_t capacity);
+};
+
+#endif //OOP_USERINDEX_H
@@ -0,0 +1,175 @@
+#ifndef OOP_WRITEAHEADLOG_H
+#define OOP_WRITEAHEADLOG_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <LatencyHistogram.h>
+
+// Kinds of App and channel mutation in the log. Payloads are the fixed-width
+// fields in the order listed, in host byte order, followed by at most one string.
+// Song, playlist and favorite records come from a MusicChannel's own log.
+enum class LogRecordType : uint16_t {
+    user_stored = 1,       // indexed: u8, digest, salt, name
+    channel_added,         // owner position: u32, name
+    subscribed,            // user position: u32, channel row: u32
+    unsubscribed,          // user position: u32, channel row: u32
+    channel_subscribed,    // channel row: u32 (anonymous, through a Channel view)
+    channel_unsubscribed,  // channel row: u32
+    video_published,       // channel row: u32, title
+    song_added,            // channel row: u32, title
+    playlist_inserted,     // channel row: u32, position: u64, title
+    playlist_removed,      // channel row: u32, title
+    playlist_moved,        // channel row: u32, position: u64, title
+    favorite_marked,       // channel row: u32, title
+    favorite_unmarked,     // channel row: u32, title
+};
+
+// File layout: a 16-byte header, then records back to back. A record is a
+// 32-byte header followed by its payload; the header carries the payload size,
+// the type, a sequence number above the previous record's and a BLAKE2b-128
+// checksum of all of these and the payload.
+namespace log_format {
+    inline constexpr std::array<char, 8> magic{'O', 'O', 'P', 'W', 'A', 'L', '\0', '\0'};
+    inline constexpr uint32_t version = 1;
+    inline constexpr uint32_t byte_order = 0x01020304;
+    inline constexpr uint32_t max_payload = 1u << 20;
+
+    using Checksum = std::array<uint8_t, 16>;
+
+    struct Header {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t byteOrder;
+    };
+
+    struct RecordHeader {
+        uint32_t size;
+        uint16_t type;
+        uint16_t reserved;
+        uint64_t sequence;
+        Checksum checksum;
+    };
+
+    static_assert(sizeof(Header) == 16 && sizeof(RecordHeader) == 32);
+}
+
+// Append-only log of App mutations. append() only buffers the record; sync()
+// blocks until it is on disk. Threads waiting in sync() share fsyncs: the first
+// one writes everything buffered so far and flushes it while the others wait,
+// and any records appended meanwhile go out together in the next flush.
+//
+// append() and sync() may be called from any number of threads. A caller that
+// serialises its mutations with a lock should append under the lock and sync
+// after releasing it, or every commit pays for a flush of its own.
+class WriteAheadLog {
+public:
+    using Sequence = uint64_t;
+
+    struct Record {
+        Sequence sequence;
+        LogRecordType type;
+        std::string_view payload;
+    };
+
+    // Reads the fields of a record's payload in the order they were appended.
+    class PayloadReader {
+    public:
+        explicit PayloadReader(const Record& entry) : entry(entry), rest(entry.payload) {}
+
+        template<typename T>
+        T take() {
+            if (rest.size() < sizeof(T))
+                damaged();
+            T value;
+            std::memcpy(&value, rest.data(), sizeof(T));
+            rest.remove_prefix(sizeof(T));
+            return value;
+        }
+
+        // The rest of the payload.
+        std::string_view text() { return std::exchange(rest, {}); }
+
+        [[noreturn]] void damaged() const {
+            throw std::runtime_error("Damaged write-ahead log record " + std::to_string(entry.sequence));
+        }
+
+    private:
+        const Record& entry;
+        std::string_view rest;
+    };
+
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+        uint64_t fsyncs = 0;
+        double seconds = 0;  // since the log was opened
+        LatencyHistogram commit;  // time spent in sync()
+
+        friend std::ostream& operator<<(std::ostream& os, const Stats& stats);
+    };
+
+    // Opens the log, creating it if needed. A torn or damaged tail, as left by a
+    // crash in the middle of a write, is cut off at the last intact record.
+    explicit WriteAheadLog(std::filesystem::path path);
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+    // Flushes whatever is still buffered; errors are dropped.
+    ~WriteAheadLog();
+
+    // Calls apply for every record in the file after the given sequence, in order.
+    void replay(Sequence after, const std::function<void(const Record&)>& apply) const;
+
+    // The payload is the concatenation of the parts; returns the record's sequence.
+    Sequence append(LogRecordType type, std::initializer_list<std::string_view> payload);
+    // Numbers the next record above the given sequence, for a log that is older
+    // than the state it is about to extend. Does nothing once records are buffered.
+    void continueAfter(Sequence sequence);
+    // Returns once every record up to the given sequence is on disk. Throws
+    // std::system_error if writing or flushing fails; the log stays failed after that.
+    void sync(Sequence upTo);
+    void sync() { sync(lastAppended()); }
+
+    [[nodiscard]] Sequence lastAppended() const;
+    [[nodiscard]] Sequence lastDurable() const;
+    [[nodiscard]] Stats stats() const;
+
+    // The bytes of a trivially copyable value, as one part of a payload.
+    template<typename T>
+    [[nodiscard]] static std::string_view field(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Log payloads hold plain values");
+        return {reinterpret_cast<const char*>(&value), sizeof(T)};
+    }
+
+private:
+    std::filesystem::path path;
+    int fd = -1;
+    std::chrono::steady_clock::time_point opened;
+
+    mutable std::mutex mutex;
+    std::condition_variable flushed;
+    std::string pending;  // encoded records not yet written
+    Sequence appended = 0;
+    Sequence durable = 0;
+    bool flushing = false;
+    std::exception_ptr failure;
+    Stats counters;
+
+    void writeOut(const std::string& batch);
+};
+
+#endif //OOP_WRITEAHEADLOG_H
@@ -0,0 +1,159 @@
+#include <App.h>
+
+#include <Snapshot.h>
+
+std::vector<Channel*> App::getChannels() {
+    channelPool.reserve(channelTable->size());
+    for (auto row = static_cast<ChannelTable::Row>(channels.size()); row < channelTable->size(); row++) {
+        channels.push_back(channelPool.create(*channelTable, row, userAt(channelTable->owner(row))));
+        channelPool[channels.back()].attachLog(log);
+    }
+    std::vector<Channel*> result;
+    result.reserve(channels.size());
+    for (auto channel : channels)
+        result.push_back(&channelPool[channel]);
+    return result;
+}
+
+void App::saveSnapshot(const std::filesystem::path& path) const {
+    SnapshotWriter out(path);
+    std::vector<PasswordManager::Digest> digests;
+    std::vector<PasswordManager::Salt> salts;
+    std::vector<uint64_t> nameOffsets{0};
+    std::string names;
+    digests.reserve(userCount());
+    salts.reserve(userCount());
+    nameOffsets.reserve(userCount() + 1);
+    // the mapped users as they were saved, then those stored since
+    digests.assign(mapped.digests.begin(), mapped.digests.end());
+    salts.assign(mapped.salts.begin(), mapped.salts.end());
+    if (mapped.size() > 0) {
+        nameOffsets.assign(mapped.nameOffsets.begin(), mapped.nameOffsets.end());
+        names.assign(mapped.names);
+    }
+    users.forEach([&](const User& user) {
+        digests.push_back(user.getDigest());
+        salts.push_back(user.getSalt());
+        names.append(user.getUsername());
+        nameOffsets.push_back(names.size());
+    });
+    out.add(SnapshotSection::user_digests, digests);
+    out.add(SnapshotSection::user_salts, salts);
+    out.add(SnapshotSection::user_name_offsets, nameOffsets);
+    out.add(SnapshotSection::user_name_bytes, std::string_view(names));
+    userIndex.save(out);
+    channelTable->save(out);
+    subscriptions.save(out);
+    out.add(SnapshotSection::log_position, std::vector<uint64_t>{loggedThrough()});
+    out.commit();
+}
+
+App::App(std::shared_ptr<const Snapshot> snapshot) {
+    const auto digests = snapshot->section<PasswordManager::Digest>(SnapshotSection::user_digests);
+    const auto salts = snapshot->section<PasswordManager::Salt>(SnapshotSection::user_salts);
+    const auto nameOffsets = snapshot->section<uint64_t>(SnapshotSection::user_name_offsets);
+    const auto names = snapshot->bytes(SnapshotSection::user_name_bytes);
+    if (digests.size() >= UINT32_MAX || salts.size() != digests.size() || nameOffsets.size() != digests.size() + 1 ||
+        nameOffsets.front() != 0 || nameOffsets.back() != names.size() ||
+        !std::is_sorted(nameOffsets.begin(), nameOffsets.end()))
+        throw std::runtime_error("Damaged user table in snapshot");
+    userIndex.load(snapshot, digests.size());
+
+    channelTable->load(snapshot);
+    for (ChannelTable::Row row = 0; row < channelTable->size(); row++)
+        if (channelTable->owner(row) >= digests.size())
+            throw std::runtime_error("Damaged channel table in snapshot");
+    subscriptions.load(snapshot, digests.size(), channelTable->size());
+    if (snapshot->has(SnapshotSection::log_position)) {
+        const auto position = snapshot->section<uint64_t>(SnapshotSection::log_position);
+        if (position.size() != 1)
+            throw std::runtime_error("Damaged log position in snapshot");
+        logPosition = position[0];
+    }
+    mapped = {std::move(snapshot), digests, salts, nameOffsets, names};
+}
+
+App App::loadSnapshot(const std::filesystem::path& path) {
+    auto snapshot = std::make_shared<const Snapshot>(path);
+    snapshot->verify();
+    return App(std::move(snapshot));
+}
+
+void App::apply(const WriteAheadLog::Record& entry) {
+    WriteAheadLog::PayloadReader in(entry);
+    const auto userAt = [&](uint32_t position) {
+        if (position >= userCount())
+            in.damaged();
+        return position;
+    };
+    const auto rowAt = [&](ChannelTable::Row row) {
+        if (row >= channelTable->size())
+            in.damaged();
+        return row;
+    };
+
+    switch (entry.type) {
+        case LogRecordType::user_stored: {
+            const bool indexed = in.take<uint8_t>() != 0;
+            const auto digest = in.take<PasswordManager::Digest>();
+            const auto salt = in.take<PasswordManager::Salt>();
+            storeUser(User(digest, in.text(), salt), indexed);
+            break;
+        }
+        case LogRecordType::channel_added: {
+            const uint32_t owner = userAt(in.take<uint32_t>());
+            channelTable->add(std::string(in.text()), owner);
+            break;
+        }
+        case LogRecordType::subscribed: {
+            const uint32_t user = userAt(in.take<uint32_t>());
+            const ChannelTable::Row row = rowAt(in.take<ChannelTable::Row>());
+            if (subscriptions.subscribe(user, row))
+                channelTable->subscribe(row);
+            break;
+        }
+        case LogRecordType::unsubscribed: {
+            const uint32_t user = userAt(in.take<uint32_t>());
+            const ChannelTable::Row row = rowAt(in.take<ChannelTable::Row>());
+            if (subscriptions.unsubscribe(user, row))
+                channelTable->unsubscribe(row);
+            break;
+        }
+        case LogRecordType::channel_subscribed:
+            channelTable->subscribe(rowAt(in.take<ChannelTable::Row>()));
+            break;
+        case LogRecordType::channel_unsubscribed:
+            channelTable->unsubscribe(rowAt(in.take<ChannelTable::Row>()));
+            break;
+        case LogRecordType::video_published: {
+            const ChannelTable::Row row = rowAt(in.take<ChannelTable::Row>());
+            channelTable->publishVideo(row, std::string(in.text()));
+            break;
+        }
+        default:
+            in.damaged();
+    }
+}
+
+void App::attachLog(WriteAheadLog& wal) {
+    detachLog();
+    wal.replay(logPosition, [this](const WriteAheadLog::Record& entry) {
+        apply(entry);
+        logPosition = entry.sequence;
+    });
+    // a log older than the state (say, one restarted after a snapshot) continues
+    // numbering above it, so replaying after that snapshot skips nothing new
+    wal.continueAfter(logPosition);
+    log = &wal;
+    for (auto channel : channels)
+        channelPool[channel].attachLog(log);
+}
+
+void App::detachLog() {
+    if (!log)
+        return;
+    logPosition = log->lastAppended();
+    log = nullptr;
+    for (auto channel : channels)
+        channelPool[channel].attachLog(nullptr);
+}
@@ -0,0 +1,138 @@
+#include <Channel.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <Snapshot.h>
+
+Channel::Channel(std::shared_ptr<const Snapshot> snapshot, User* ownerPtr)
+    : ownTable(std::make_unique<ChannelTable>()), table(ownTable.get()), row(0), owner(ownerPtr) {
+    ownTable->load(std::move(snapshot));
+    if (ownTable->size() != 1)
+        throw std::runtime_error("Damaged channel table in snapshot");
+}
+
+void Channel::replay(const WriteAheadLog& channelLog, WriteAheadLog::Sequence after) {
+    // mutations redone from the log must not be appended to a log again
+    WriteAheadLog* const attached = log;
+    log = nullptr;
+    try {
+        channelLog.replay(after, [this](const WriteAheadLog::Record& entry) { apply(entry); });
+    } catch (...) {
+        log = attached;
+        throw;
+    }
+    log = attached;
+}
+
+void Channel::apply(const WriteAheadLog::Record& entry) {
+    WriteAheadLog::PayloadReader in(entry);
+    switch (entry.type) {
+        case LogRecordType::channel_subscribed:
+            if (ours(in))
+                subscribe();
+            break;
+        case LogRecordType::channel_unsubscribed:
+            if (ours(in))
+                unsubscribe();
+            break;
+        case LogRecordType::video_published:
+            if (ours(in))
+                publishVideo(std::string(in.text()));
+            break;
+        default:
+            in.damaged();
+    }
+}
+
+// Titles are logged rather than song ids, which depend on the order titles were
+// first seen; replaying through the public calls hands out the same ids anyway.
+void MusicChannel::apply(const WriteAheadLog::Record& entry) {
+    WriteAheadLog::PayloadReader in(entry);
+    switch (entry.type) {
+        case LogRecordType::song_added:
+            if (ours(in))
+                addSong(in.text());
+            break;
+        case LogRecordType::playlist_inserted:
+            if (ours(in)) {
+                const auto position = static_cast<size_t>(in.take<uint64_t>());
+                insertIntoPlaylist(in.text(), position);
+            }
+            break;
+        case LogRecordType::playlist_removed:
+            if (ours(in))
+                removeFromPlaylist(in.text());
+            break;
+        case LogRecordType::playlist_moved:
+            if (ours(in)) {
+                const auto position = static_cast<size_t>(in.take<uint64_t>());
+                moveInPlaylist(in.text(), position);
+            }
+            break;
+        case LogRecordType::favorite_marked:
+            if (ours(in))
+                markFavorite(in.text());
+            break;
+        case LogRecordType::favorite_unmarked:
+            if (ours(in))
+                unmarkFavorite(in.text());
+            break;
+        default:
+            Channel::apply(entry);
+    }
+}
+
+MusicChannel::MusicChannel(std::shared_ptr<const Snapshot> snapshot, User* ownerPtr)
+    : Channel(snapshot, ownerPtr), songTitles(), songIds(), songs(), playlist(), favorites(), songIndex() {
+    const auto titleOffsets = snapshot->section<uint64_t>(SnapshotSection::song_title_offsets);
+    const auto titleBytes = snapshot->bytes(SnapshotSection::song_title_bytes);
+    if (titleOffsets.empty() || titleOffsets.size() - 1 > UINT32_MAX || titleOffsets.front() != 0 ||
+        titleOffsets.back() != titleBytes.size() || !std::is_sorted(titleOffsets.begin(), titleOffsets.end()))
+        throw std::runtime_error("Damaged songs in snapshot");
+    const size_t titles = titleOffsets.size() - 1;
+    // ids are dense in the order titles were first seen, so interning them in order hands out the same ones
+    for (size_t id = 0; id < titles; id++)
+        if (intern(titleBytes.substr(titleOffsets[id], titleOffsets[id + 1] - titleOffsets[id])) != id)
+            throw std::runtime_error("Damaged songs in snapshot");
+    setLabel(snapshot->bytes(SnapshotSection::music_label));
+
+    for (SongId id : snapshot->section<SongId>(SnapshotSection::songs)) {
+        if (id >= titles)
+            throw std::runtime_error("Damaged songs in snapshot");
+        songIndex.add(titleOf(id));
+        songs.push_back(id);
+    }
+    for (SongId id : snapshot->section<SongId>(SnapshotSection::playlist_songs))
+        if (id >= titles || !playlist.push_back(id))
+            throw std::runtime_error("Damaged playlist in snapshot");
+    for (SongId id : snapshot->section<SongId>(SnapshotSection::favorite_songs))
+        if (!playlist.contains(id) || !favorites.push_back(id))
+            throw std::runtime_error("Damaged favorites in snapshot");
+}
+
+void MusicChannel::saveSnapshot(const std::filesystem::path& path) const {
+    SnapshotWriter out(path);
+    channelTable().save(out);
+    out.add(SnapshotSection::music_label, getLabel());
+
+    std::vector<uint64_t> titleOffsets{0};
+    std::string titleBytes;
+    titleOffsets.reserve(songTitles.size() + 1);
+    for (SongId id = 0; id < songTitles.size(); id++) {
+        titleBytes.append(titleOf(id));
+        titleOffsets.push_back(titleBytes.size());
+    }
+    out.add(SnapshotSection::song_title_offsets, titleOffsets);
+    out.add(SnapshotSection::song_title_bytes, std::string_view(titleBytes));
+    out.add(SnapshotSection::songs, songs);
+
+    std::vector<SongId> order;
+    order.reserve(playlist.size());
+    playlist.forEach([&](SongId id) { order.push_back(id); });
+    out.add(SnapshotSection::playlist_songs, order);
+    order.clear();
+    favorites.forEach([&](SongId id) { order.push_back(id); });
+    out.add(SnapshotSection::favorite_songs, order);
+    out.commit();
+}
@@ -0,0 +1,197 @@
+#include <ChannelTable.h>
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <Snapshot.h>
+
+namespace {
+    // A column copied out into one array, for writing as a snapshot section.
+    template<typename T, size_t LeafSize>
+    std::vector<T> flatten(const PersistentVector<T, LeafSize>& column) {
+        std::vector<T> values;
+        values.reserve(column.size());
+        column.forEachChunk([&](std::span<const T> chunk) { values.insert(values.end(), chunk.begin(), chunk.end()); });
+        return values;
+    }
+}
+
+ChannelTable::ChannelTable() : subscriberCounters(), subscriberSnapshot(), ownerId(), videoCount(), mapped(), nameSymbol(), titles(), laterTitles(), videoIndex(), videoDocs() {}
+
+ChannelTable::Row ChannelTable::add(std::string_view name, uint32_t owner) {
+    const auto row = static_cast<Row>(size());
+    subscriberCounters.resize(row + size_t{1});
+    subscriberSnapshot.push_back(0);
+    ownerId.push_back(owner);
+    videoCount.push_back(0);
+    nameSymbol.push_back(StringInterner::global().intern(name));
+    titles.push_back({});
+    return row;
+}
+
+void ChannelTable::publishVideo(Row row, const std::string& title) {
+    videoDocs.push_back({row, videoCount[row]});
+    videoIndex.add(title);
+    const StringInterner::Symbol symbol = StringInterner::global().intern(title);
+    if (row < mapped.rows)
+        laterTitles.write()[row].push_back(symbol);
+    else
+        titles.edit(row - mapped.rows).push_back(symbol);
+    ++videoCount.edit(row);
+}
+
+std::string_view ChannelTable::videoTitle(Row row, uint32_t video) const {
+    if (row >= mapped.rows)
+        return StringInterner::global().view(titles[row - mapped.rows][video]);
+    const uint64_t first = mapped.titleOffsets[row];
+    const uint64_t saved = mapped.titleOffsets[row + 1] - first;
+    if (video < saved)
+        return Mapped::text(mapped.titles, mapped.titleStarts, first + video);
+    return StringInterner::global().view(laterTitles->at(row)[video - saved]);
+}
+
+std::vector<ChannelTable::VideoRef> ChannelTable::searchVideos(std::string_view query, size_t limit) const {
+    std::vector<VideoRef> result;
+    for (TitleIndex::DocId doc : videoIndex.search(query, limit))
+        result.push_back(doc < mapped.docs.size() ? mapped.docs[doc] : videoDocs[doc - mapped.docs.size()]);
+    return result;
+}
+
+// Only rows whose count moved are written, so leaves shared with a copy of the
+// table are cloned only where something changed.
+void ChannelTable::refreshSubscriberSnapshot() {
+    for (Row row = 0; row < size(); row++) {
+        const uint64_t exact = subscriberCounters.exact(row);
+        const uint32_t count = exact > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(exact);
+        if (subscriberSnapshot[row] != count)
+            subscriberSnapshot.edit(row) = count;
+    }
+}
+
+// A plain reduction over each leaf; the compiler vectorizes it.
+uint64_t ChannelTable::totalSubscribers() const {
+    uint64_t total = 0;
+    subscriberSnapshot.forEachChunk([&](std::span<const uint32_t> chunk) {
+        for (uint32_t count : chunk)
+            total += count;
+    });
+    return total;
+}
+
+std::vector<ChannelTable::Row> ChannelTable::topBySubscribers(size_t k) const {
+    k = std::min(k, size());
+    if (k == 0)
+        return {};
+
+    // a k-element min-heap on (count, row) over one pass of the count column
+    auto better = [](const std::pair<uint32_t, Row>& a, const std::pair<uint32_t, Row>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    std::vector<std::pair<uint32_t, Row>> heap;
+    heap.reserve(k);
+    Row row = 0;
+    subscriberSnapshot.forEach([&](uint32_t count) {
+        if (heap.size() < k) {
+            heap.emplace_back(count, row);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (count > heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = {count, row};
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+        ++row;
+    });
+    std::sort_heap(heap.begin(), heap.end(), better);
+
+    std::vector<Row> rows;
+    rows.reserve(k);
+    for (const auto& entry : heap)
+        rows.push_back(entry.second);
+    return rows;
+}
+
+void ChannelTable::save(SnapshotWriter& out) const {
+    std::vector<uint64_t> subscribers(size());
+    for (Row row = 0; row < size(); row++)
+        subscribers[row] = subscriberCounters.exact(row);
+    out.add(SnapshotSection::channel_owners, flatten(ownerId));
+    out.add(SnapshotSection::channel_subscribers, subscribers);
+    out.add(SnapshotSection::channel_videos, flatten(videoCount));
+
+    std::vector<uint64_t> nameOffsets{0};
+    std::string nameBytes;
+    nameOffsets.reserve(size() + 1);
+    for (Row row = 0; row < size(); row++) {
+        nameBytes.append(name(row));
+        nameOffsets.push_back(nameBytes.size());
+    }
+    out.add(SnapshotSection::channel_name_offsets, nameOffsets);
+    out.add(SnapshotSection::channel_name_bytes, std::string_view(nameBytes));
+
+    std::vector<uint64_t> titleOffsets{0};
+    std::vector<uint64_t> titleStarts{0};
+    std::string titleBytes;
+    titleOffsets.reserve(size() + 1);
+    titleStarts.reserve(videoDocs.size() + 1);
+    for (Row row = 0; row < size(); row++) {
+        for (uint32_t video = 0; video < videos(row); video++) {
+            titleBytes.append(videoTitle(row, video));
+            titleStarts.push_back(titleBytes.size());
+        }
+        titleOffsets.push_back(titleStarts.size() - 1);
+    }
+    out.add(SnapshotSection::video_title_offsets, titleOffsets);
+    out.add(SnapshotSection::video_title_starts, titleStarts);
+    out.add(SnapshotSection::video_title_bytes, std::string_view(titleBytes));
+    std::vector<VideoRef> docs(mapped.docs.begin(), mapped.docs.end());
+    const std::vector<VideoRef> later = flatten(videoDocs);
+    docs.insert(docs.end(), later.begin(), later.end());
+    out.add(SnapshotSection::video_docs, docs);
+    videoIndex.save(out);
+}
+
+void ChannelTable::load(std::shared_ptr<const Snapshot> in) {
+    const auto owners = in->section<uint32_t>(SnapshotSection::channel_owners);
+    const auto subscribers = in->section<uint64_t>(SnapshotSection::channel_subscribers);
+    const auto videos = in->section<uint32_t>(SnapshotSection::channel_videos);
+    const auto nameOffsets = in->section<uint64_t>(SnapshotSection::channel_name_offsets);
+    const auto nameBytes = in->bytes(SnapshotSection::channel_name_bytes);
+    const auto titleOffsets = in->section<uint64_t>(SnapshotSection::video_title_offsets);
+    const auto titleStarts = in->section<uint64_t>(SnapshotSection::video_title_starts);
+    const auto titleBytes = in->bytes(SnapshotSection::video_title_bytes);
+    const auto docs = in->section<VideoRef>(SnapshotSection::video_docs);
+    const size_t rows = owners.size();
+    if (rows > UINT32_MAX || subscribers.size() != rows || videos.size() != rows || nameOffsets.size() != rows + 1 ||
+        nameOffsets.front() != 0 || nameOffsets.back() != nameBytes.size() || titleOffsets.size() != rows + 1 ||
+        titleOffsets.front() != 0 || titleOffsets.back() + 1 != titleStarts.size() || titleStarts.front() != 0 ||
+        titleStarts.back() != titleBytes.size() ||
+        docs.size() + 1 != titleStarts.size() || !std::is_sorted(nameOffsets.begin(), nameOffsets.end()) ||
+        !std::is_sorted(titleOffsets.begin(), titleOffsets.end()) || !std::is_sorted(titleStarts.begin(), titleStarts.end()))
+        throw std::runtime_error("Damaged channel table in snapshot");
+    for (Row row = 0; row < rows; row++)
+        if (videos[row] != titleOffsets[row + 1] - titleOffsets[row])
+            throw std::runtime_error("Damaged channel table in snapshot");
+    for (const VideoRef& doc : docs)
+        if (doc.channel >= rows || doc.video >= videos[doc.channel])
+            throw std::runtime_error("Damaged channel table in snapshot");
+
+    ownerId = Column(owners);
+    videoCount = Column(videos);
+    subscriberCounters = StripedCounters();
+    subscriberCounters.resize(rows);
+    std::vector<uint32_t> counts(rows);
+    for (Row row = 0; row < rows; row++) {
+        subscriberCounters.assign(row, subscribers[row]);
+        counts[row] = subscribers[row] > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(subscribers[row]);
+    }
+    subscriberSnapshot = Column(std::span<const uint32_t>(counts));
+    videoIndex.load(*in);
+    if (videoIndex.size() != docs.size())
+        throw std::runtime_error("Damaged channel table in snapshot");
+    mapped = {nullptr, static_cast<Row>(rows), nameOffsets, nameBytes, titleOffsets, titleStarts, titleBytes, docs};
+    mapped.snapshot = std::move(in);
+    nameSymbol = PersistentVector<StringInterner::Symbol, column_leaf>();
+    titles = PersistentVector<std::vector<StringInterner::Symbol>>();
+    laterTitles = CopyOnWrite<std::unordered_map<Row, std::vector<StringInterner::Symbol>>>();
+    videoDocs = PersistentVector<VideoRef>();
+}
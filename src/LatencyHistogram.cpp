@@ -0,0 +1,65 @@
+#include <LatencyHistogram.h>
+
+#include <bit>
+#include <cmath>
+
+// Values below 2^sub_bucket_bits get a bucket each; above that the bucket is
+// the position of the leading bit plus the next sub_bucket_bits bits.
+size_t LatencyHistogram::bucketOf(uint64_t ns) {
+    constexpr uint64_t linear = 1u << sub_bucket_bits;
+    if (ns < linear)
+        return static_cast<size_t>(ns);
+    const unsigned exponent = static_cast<unsigned>(std::bit_width(ns)) - 1;
+    const uint64_t mantissa = (ns >> (exponent - sub_bucket_bits)) & (linear - 1);
+    return ((exponent - sub_bucket_bits + 1) << sub_bucket_bits) + static_cast<size_t>(mantissa);
+}
+
+uint64_t LatencyHistogram::upperBound(size_t bucket) {
+    constexpr uint64_t linear = 1u << sub_bucket_bits;
+    if (bucket < linear)
+        return bucket;
+    const unsigned exponent = static_cast<unsigned>(bucket >> sub_bucket_bits) + sub_bucket_bits - 1;
+    const uint64_t mantissa = bucket & (linear - 1);
+    const uint64_t width = uint64_t{1} << (exponent - sub_bucket_bits);
+    return (uint64_t{1} << exponent) + (mantissa + 1) * width - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    ++buckets[bucketOf(ns)];
+    ++total;
+    sum += ns;
+    if (ns > largest)
+        largest = ns;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < bucket_count; i++)
+        buckets[i] += other.buckets[i];
+    total += other.total;
+    sum += other.sum;
+    if (other.largest > largest)
+        largest = other.largest;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0)
+        return 0;
+    const auto rank = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; i++) {
+        seen += buckets[i];
+        if (seen >= rank && seen > 0)
+            return upperBound(i) < largest ? upperBound(i) : largest;
+    }
+    return largest;
+}
+
+std::ostream& operator<<(std::ostream& os, const LatencyHistogram& histogram) {
+    os << "count=" << histogram.count()
+       << " mean=" << static_cast<uint64_t>(histogram.mean()) << "ns"
+       << " p50=" << histogram.percentile(50) << "ns"
+       << " p90=" << histogram.percentile(90) << "ns"
+       << " p99=" << histogram.percentile(99) << "ns"
+       << " max=" << histogram.max() << "ns";
+    return os;
+}
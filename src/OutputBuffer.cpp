@@ -0,0 +1,16 @@
+#include <OutputBuffer.h>
+
+OutputBuffer::OutputBuffer(std::ostream& os, size_t flushThreshold) : out(os), buffer(), threshold(flushThreshold) {
+    buffer.reserve(threshold + threshold / 8);
+}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::flush() {
+    if (buffer.empty())
+        return;
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
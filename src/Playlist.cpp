@@ -0,0 +1,129 @@
+#include <Playlist.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+std::pair<size_t, size_t> Playlist::locate(size_t position) const {
+    size_t index = 0;
+    for (; index + 1 < order.size(); index++) {
+        const size_t length = chunks[order[index]].size();
+        if (position < length)
+            break;
+        position -= length;
+    }
+    return {index, position};
+}
+
+uint32_t Playlist::newChunk() {
+    if (!freeChunks.empty()) {
+        const uint32_t slot = freeChunks.back();
+        freeChunks.pop_back();
+        return slot;
+    }
+    chunks.emplace_back();
+    chunks.back().reserve(chunk_capacity);
+    return static_cast<uint32_t>(chunks.size() - 1);
+}
+
+void Playlist::releaseChunk(size_t orderIndex) {
+    const uint32_t slot = order[orderIndex];
+    chunks[slot].clear();
+    freeChunks.push_back(slot);
+    order.erase(order.begin() + static_cast<std::ptrdiff_t>(orderIndex));
+}
+
+bool Playlist::insert(size_t position, SongId id) {
+    if (contains(id))
+        return false;
+    if (id >= chunkOf.size())
+        chunkOf.resize(id + size_t{1}, no_chunk);
+    if (order.empty())
+        order.push_back(newChunk());
+
+    auto [index, offset] = locate(std::min(position, count));
+    if (chunks[order[index]].size() == chunk_capacity) {
+        // a full chunk is split before it can grow past its reserved capacity;
+        // appending at the very end starts a fresh chunk so the full one stays full
+        const uint32_t split = newChunk();
+        auto& full = chunks[order[index]];
+        if (index + 1 < order.size() || offset < full.size()) {
+            const auto half = full.begin() + static_cast<std::ptrdiff_t>(full.size() / 2);
+            chunks[split].assign(half, full.end());
+            full.erase(half, full.end());
+            for (SongId moved : chunks[split])
+                chunkOf[moved] = split;
+        }
+        order.insert(order.begin() + static_cast<std::ptrdiff_t>(index + 1), split);
+        if (offset >= chunks[order[index]].size()) {
+            offset -= chunks[order[index]].size();
+            ++index;
+        }
+    }
+    const uint32_t slot = order[index];
+    auto& chunk = chunks[slot];
+    chunk.insert(chunk.begin() + static_cast<std::ptrdiff_t>(offset), id);
+    chunkOf[id] = slot;
+    ++count;
+    return true;
+}
+
+bool Playlist::erase(SongId id) {
+    if (!contains(id))
+        return false;
+    const uint32_t slot = chunkOf[id];
+    auto& chunk = chunks[slot];
+    chunk.erase(std::find(chunk.begin(), chunk.end(), id));
+    chunkOf[id] = no_chunk;
+    --count;
+
+    // keep chunks at least a quarter full so the chunk walk stays short
+    if (chunk.size() >= chunk_capacity / 4)
+        return true;
+    const auto index = static_cast<size_t>(std::find(order.begin(), order.end(), slot) - order.begin());
+    if (chunk.empty()) {
+        releaseChunk(index);
+    } else if (index + 1 < order.size() && chunk.size() + chunks[order[index + 1]].size() <= chunk_capacity) {
+        const uint32_t next = order[index + 1];
+        for (SongId moved : chunks[next])
+            chunkOf[moved] = slot;
+        chunk.insert(chunk.end(), chunks[next].begin(), chunks[next].end());
+        releaseChunk(index + 1);
+    }
+    return true;
+}
+
+bool Playlist::move(SongId id, size_t position) {
+    if (!erase(id))
+        return false;
+    insert(position, id);
+    return true;
+}
+
+size_t Playlist::position(SongId id) const {
+    if (!contains(id))
+        return npos;
+    const uint32_t slot = chunkOf[id];
+    size_t before = 0;
+    for (uint32_t chunk : order) {
+        if (chunk == slot)
+            break;
+        before += chunks[chunk].size();
+    }
+    const auto& chunk = chunks[slot];
+    return before + static_cast<size_t>(std::find(chunk.begin(), chunk.end(), id) - chunk.begin());
+}
+
+Playlist::SongId Playlist::at(size_t position) const {
+    if (position >= count)
+        throw std::out_of_range("Playlist position out of range");
+    const auto [index, offset] = locate(position);
+    return chunks[order[index]][offset];
+}
+
+size_t Playlist::memoryUsage() const {
+    size_t bytes = sizeof(*this) + chunks.capacity() * sizeof(chunks[0]) + order.capacity() * sizeof(uint32_t) +
+                   freeChunks.capacity() * sizeof(uint32_t) + chunkOf.capacity() * sizeof(uint32_t);
+    for (const auto& chunk : chunks)
+        bytes += chunk.capacity() * sizeof(SongId);
+    return bytes;
+}
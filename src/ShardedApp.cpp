@@ -0,0 +1,191 @@
+#include <ShardedApp.h>
+
+#include <mutex>
+#include <stdexcept>
+
+ShardedApp::ShardedApp(size_t shardCount) {
+    if (shardCount == 0)
+        throw std::invalid_argument("ShardedApp needs at least one shard");
+    shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; i++)
+        shards.push_back(std::make_unique<Shard>());
+}
+
+// UserIndex picks slots with the low bits of the hash; the shard comes from the
+// top ones so that each shard's index still sees well spread hashes.
+size_t ShardedApp::shardOf(std::string_view name) const {
+    return static_cast<size_t>((UserIndex::hash(name) >> 48) % shards.size());
+}
+
+bool ShardedApp::validChannel(ChannelId channel) const {
+    return channel != none && localId(channel) < shards[shardOfId(channel)]->channelRows.load(std::memory_order_acquire);
+}
+
+ShardedApp::UserId ShardedApp::addUser(std::string_view username, const std::string& password) {
+    const PasswordManager::Salt salt = PasswordManager::make_salt();
+    return addUser(username, PasswordManager::hash_password(password, salt), salt);
+}
+
+ShardedApp::UserId ShardedApp::addUser(std::string_view username, const PasswordManager::Digest& digest,
+                                       const PasswordManager::Salt& salt) {
+    if (username.empty())
+        return none;
+    const size_t index = shardOf(username);
+    Shard& shard = *shards[index];
+    const std::unique_lock lock(shard.mutex);
+    const auto position = static_cast<uint32_t>(shard.users.size());
+    if (!shard.userIndex.insert(username, position))
+        return none;
+    shard.users.push_back(shard.userPool.create(digest, username, salt));
+    return globalId(position, index);
+}
+
+bool ShardedApp::login(std::string_view username, const std::string& password) const {
+    const Shard& shard = *shards[shardOf(username)];
+    std::optional<User> account;
+    {
+        const std::shared_lock lock(shard.mutex);
+        const uint32_t position = shard.userIndex.find(username);
+        if (position != UserIndex::npos)
+            account = shard.userPool[shard.users[position]];
+    }
+    // unknown names still pay for a hash, so response time does not reveal which accounts exist
+    const User& checked = account ? *account : User();
+    const bool match = PasswordManager::verify_password(password, checked.getSalt(), checked.getDigest());
+    return account && match;
+}
+
+ShardedApp::UserId ShardedApp::findUser(std::string_view username) const {
+    const size_t index = shardOf(username);
+    const Shard& shard = *shards[index];
+    const std::shared_lock lock(shard.mutex);
+    const uint32_t position = shard.userIndex.find(username);
+    return position == UserIndex::npos ? none : globalId(position, index);
+}
+
+std::optional<User> ShardedApp::getUser(UserId id) const {
+    if (id == none)
+        return std::nullopt;
+    const Shard& shard = *shards[shardOfId(id)];
+    const std::shared_lock lock(shard.mutex);
+    if (localId(id) >= shard.users.size())
+        return std::nullopt;
+    return shard.userPool[shard.users[localId(id)]];
+}
+
+ShardedApp::ChannelId ShardedApp::addChannel(std::string_view channelName, std::string_view ownerName) {
+    const UserId owner = findUser(ownerName);
+    if (owner == none)
+        return none;
+    const size_t index = shardOf(channelName);
+    Shard& shard = *shards[index];
+    const std::unique_lock lock(shard.mutex);
+    const ChannelTable::Row row = shard.channels.add(channelName, owner);
+    shard.channelRows.store(row + 1, std::memory_order_release);
+    return globalId(row, index);
+}
+
+bool ShardedApp::publishVideo(ChannelId channel, const std::string& title) {
+    if (!validChannel(channel))
+        return false;
+    Shard& shard = *shards[shardOfId(channel)];
+    const std::unique_lock lock(shard.mutex);
+    shard.channels.publishVideo(localId(channel), title);
+    return true;
+}
+
+std::string ShardedApp::channelName(ChannelId channel) const {
+    if (!validChannel(channel))
+        return {};
+    const Shard& shard = *shards[shardOfId(channel)];
+    const std::shared_lock lock(shard.mutex);
+    return std::string(shard.channels.name(localId(channel)));
+}
+
+uint64_t ShardedApp::subscribers(ChannelId channel) const {
+    if (!validChannel(channel))
+        return 0;
+    const Shard& shard = *shards[shardOfId(channel)];
+    const std::shared_lock lock(shard.mutex);
+    return shard.channels.subscribers(localId(channel));
+}
+
+bool ShardedApp::changeSubscription(std::string_view username, ChannelId channel, bool subscribe) {
+    if (!validChannel(channel))
+        return false;
+    const size_t userShard = shardOf(username);
+    const size_t channelShard = shardOfId(channel);
+    Shard& shard = *shards[userShard];
+    Shard& target = *shards[channelShard];
+    // The edge and the count change in one critical section, so no reader sees
+    // one without the other. The two locks are taken in shard order, which keeps
+    // subscriptions crossing the same pair of shards from deadlocking; in a
+    // single shard the exclusive lock covers the counter as well. The counters
+    // take concurrent updates, so the channel's shard is only locked shared, to
+    // keep its table from growing under them.
+    std::unique_lock userLock(shard.mutex, std::defer_lock);
+    std::shared_lock channelLock(target.mutex, std::defer_lock);
+    if (channelShard < userShard)
+        channelLock.lock();
+    userLock.lock();
+    if (channelShard > userShard)
+        channelLock.lock();
+    const uint32_t position = shard.userIndex.find(username);
+    if (position == UserIndex::npos)
+        return false;
+    const bool changed = subscribe ? shard.subscriptions.subscribe(position, channel)
+                                   : shard.subscriptions.unsubscribe(position, channel);
+    if (!changed)
+        return false;
+    if (subscribe)
+        target.channels.subscribe(localId(channel));
+    else
+        target.channels.unsubscribe(localId(channel));
+    return true;
+}
+
+bool ShardedApp::subscribe(std::string_view username, ChannelId channel) {
+    return changeSubscription(username, channel, true);
+}
+
+bool ShardedApp::unsubscribe(std::string_view username, ChannelId channel) {
+    return changeSubscription(username, channel, false);
+}
+
+bool ShardedApp::isSubscribed(std::string_view username, ChannelId channel) const {
+    if (!validChannel(channel))
+        return false;
+    const Shard& shard = *shards[shardOf(username)];
+    const std::shared_lock lock(shard.mutex);
+    const uint32_t position = shard.userIndex.find(username);
+    return position != UserIndex::npos && shard.subscriptions.isSubscribed(position, channel);
+}
+
+std::vector<std::string_view> ShardedApp::searchVideos(std::string_view query, size_t limit) const {
+    std::vector<std::string_view> found;
+    for (const auto& shard : shards) {
+        if (found.size() >= limit)
+            break;
+        const std::shared_lock lock(shard->mutex);
+        // titles are interned, so the views outlive the lock
+        for (const auto& video : shard->channels.searchVideos(query, limit - found.size()))
+            found.push_back(shard->channels.videoTitle(video.channel, video.video));
+    }
+    return found;
+}
+
+size_t ShardedApp::userCount() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        const std::shared_lock lock(shard->mutex);
+        total += shard->users.size();
+    }
+    return total;
+}
+
+size_t ShardedApp::channelCount() const {
+    size_t total = 0;
+    for (const auto& shard : shards)
+        total += shard->channelRows.load(std::memory_order_acquire);
+    return total;
+}
@@ -0,0 +1,228 @@
+#include <Snapshot.h>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <digestpp.hpp>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr size_t leaf_size = size_t{1} << 20;
+
+    // Flushes a closed file (and on POSIX, optionally a directory) to stable storage.
+    void syncToDisk(const std::filesystem::path& path, [[maybe_unused]] bool directory = false) {
+#ifdef _WIN32
+        if (directory)
+            return;  // NTFS journals the rename itself
+        const int fd = _wopen(path.c_str(), _O_RDWR | _O_BINARY);
+        if (fd < 0 || _commit(fd) != 0) {
+            if (fd >= 0)
+                _close(fd);
+            throw std::runtime_error("Could not flush snapshot " + path.string());
+        }
+        _close(fd);
+#else
+        const int fd = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+        if (fd < 0 || ::fsync(fd) != 0) {
+            if (fd >= 0)
+                ::close(fd);
+            throw std::system_error(errno, std::generic_category(), "Could not flush snapshot " + path.string());
+        }
+        ::close(fd);
+#endif
+    }
+}
+
+snapshot_format::Checksum snapshot_format::checksum(const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    const size_t leaves = std::max<size_t>(1, (size + leaf_size - 1) / leaf_size);
+    std::vector<const unsigned char*> starts(leaves);
+    std::vector<size_t> lengths(leaves);
+    for (size_t i = 0; i < leaves; i++) {
+        starts[i] = bytes + i * leaf_size;
+        lengths[i] = std::min(leaf_size, size - std::min(size, i * leaf_size));
+    }
+    std::vector<unsigned char> digests(leaves * sizeof(Checksum));
+    digestpp::blake2b_multi(8 * sizeof(Checksum), starts.data(), lengths.data(), nullptr, digests.data(), leaves);
+
+    const uint64_t total = size;
+    return digestpp::blake2b(8 * sizeof(Checksum))
+        .absorb(reinterpret_cast<const unsigned char*>(&total), sizeof(total))
+        .absorb(digests.data(), digests.size())
+        .digest<sizeof(Checksum)>();
+}
+
+SnapshotWriter::SnapshotWriter(std::filesystem::path path)
+    : target(std::move(path)), temporary(target), file(), offset(sizeof(snapshot_format::Header)), entries() {
+    temporary += ".tmp";
+    file.open(temporary, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Could not create snapshot " + temporary.string());
+    // the header is written last, once the table's position and checksum are known
+    const snapshot_format::Header placeholder{};
+    file.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (committed)
+        return;
+    file.close();
+    std::error_code ignored;
+    std::filesystem::remove(temporary, ignored);
+}
+
+void SnapshotWriter::pad() {
+    static constexpr std::array<char, snapshot_format::alignment> zeros{};
+    const size_t padding = (snapshot_format::alignment - offset % snapshot_format::alignment) % snapshot_format::alignment;
+    file.write(zeros.data(), static_cast<std::streamsize>(padding));
+    offset += padding;
+}
+
+void SnapshotWriter::write(SnapshotSection id, const void* data, size_t size) {
+    entries.push_back({static_cast<uint32_t>(id), 0, offset, size, snapshot_format::checksum(data, size), 0});
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    offset += size;
+    pad();
+    if (!file)
+        throw std::runtime_error("Could not write snapshot " + temporary.string());
+}
+
+void SnapshotWriter::commit() {
+    const uint64_t tableOffset = offset;
+    const size_t tableSize = entries.size() * sizeof(snapshot_format::Entry);
+    file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(tableSize));
+
+    snapshot_format::Header header{};
+    header.magic = snapshot_format::magic;
+    header.version = snapshot_format::version;
+    header.byteOrder = snapshot_format::byte_order;
+    header.sectionCount = entries.size();
+    header.tableOffset = tableOffset;
+    header.tableChecksum = snapshot_format::checksum(entries.data(), tableSize);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if (!file)
+        throw std::runtime_error("Could not write snapshot " + temporary.string());
+
+    syncToDisk(temporary);
+    std::filesystem::rename(temporary, target);
+    syncToDisk(target.parent_path().empty() ? std::filesystem::path(".") : target.parent_path(), true);
+    committed = true;
+}
+
+Snapshot::Snapshot(const std::filesystem::path& path) {
+    const std::string name = path.string();
+#ifdef _WIN32
+    fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize{};
+    if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize)) {
+        fileHandle = nullptr;
+        throw std::runtime_error("Could not open snapshot " + name);
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length > 0) {
+        mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle)
+            data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (!data) {
+            unmap();
+            throw std::runtime_error("Could not map snapshot " + name);
+        }
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat status{};
+    if (fd < 0 || ::fstat(fd, &status) != 0) {
+        if (fd >= 0)
+            ::close(fd);
+        throw std::system_error(errno, std::generic_category(), "Could not open snapshot " + name);
+    }
+    length = static_cast<size_t>(status.st_size);
+    if (length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::system_error(errno, std::generic_category(), "Could not map snapshot " + name);
+        }
+        data = static_cast<const char*>(mapped);
+    }
+    ::close(fd);  // the mapping keeps the file open
+#endif
+
+    snapshot_format::Header header{};
+    if (length >= sizeof(header))
+        std::memcpy(&header, data, sizeof(header));
+    const bool valid = length >= sizeof(header) && header.magic == snapshot_format::magic &&
+                       header.byteOrder == snapshot_format::byte_order && header.tableOffset <= length &&
+                       header.tableOffset % snapshot_format::alignment == 0 &&
+                       header.sectionCount <= (length - header.tableOffset) / sizeof(snapshot_format::Entry);
+    if (!valid || header.version != snapshot_format::version) {
+        unmap();
+        throw std::runtime_error(valid ? "Unsupported snapshot version in " + name : "Not a snapshot: " + name);
+    }
+    entries = {reinterpret_cast<const snapshot_format::Entry*>(data + header.tableOffset),
+               static_cast<size_t>(header.sectionCount)};
+    const bool consistent = snapshot_format::checksum(entries.data(), entries.size_bytes()) == header.tableChecksum &&
+                            std::all_of(entries.begin(), entries.end(), [this](const snapshot_format::Entry& entry) {
+                                return entry.offset % snapshot_format::alignment == 0 && entry.offset <= length &&
+                                       entry.size <= length - entry.offset;
+                            });
+    if (!consistent) {
+        unmap();
+        throw std::runtime_error("Damaged section table in snapshot " + name);
+    }
+}
+
+Snapshot::~Snapshot() {
+    unmap();
+}
+
+void Snapshot::unmap() {
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+    if (fileHandle)
+        CloseHandle(fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    if (data)
+        ::munmap(const_cast<char*>(data), length);
+#endif
+    data = nullptr;
+}
+
+const snapshot_format::Entry* Snapshot::find(SnapshotSection id) const {
+    for (const auto& entry : entries)
+        if (entry.id == static_cast<uint32_t>(id))
+            return &entry;
+    return nullptr;
+}
+
+std::string_view Snapshot::bytes(SnapshotSection id) const {
+    const auto* entry = find(id);
+    if (!entry)
+        throw std::runtime_error("Snapshot has no section " + std::to_string(static_cast<uint32_t>(id)));
+    return {data + entry->offset, static_cast<size_t>(entry->size)};
+}
+
+void Snapshot::verify() const {
+    for (const auto& entry : entries)
+        if (snapshot_format::checksum(data + entry.offset, entry.size) != entry.checksum)
+            throw std::runtime_error("Checksum mismatch in snapshot section " + std::to_string(entry.id));
+}
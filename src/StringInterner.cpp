@@ -0,0 +1,121 @@
+#include <StringInterner.h>
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <stdexcept>
+
+StringInterner::StringInterner() : blocks(std::make_unique<std::atomic<const char*>[]>(max_blocks)), storage(), arenaMutex(), shards() {
+    intern({});  // the first string stored lands at offset 0 of block 0, which makes it symbol empty
+}
+
+StringInterner& StringInterner::global() {
+    static StringInterner interner;
+    return interner;
+}
+
+uint64_t StringInterner::hash(std::string_view text) {
+    return std::hash<std::string_view>{}(text);
+}
+
+size_t StringInterner::probe(const Shard& shard, uint32_t h, std::string_view text) const {
+    const size_t mask = shard.slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        const Slot& slot = shard.slots[i];
+        if (slot.symbol == none || (slot.hash == h && view(slot.symbol) == text))
+            return i;
+    }
+}
+
+StringInterner::Symbol StringInterner::find(std::string_view text) const {
+    const uint64_t h = hash(text);
+    const Shard& shard = shards[h >> 60];
+    std::shared_lock lock(shard.mutex);
+    if (shard.slots.empty())
+        return none;
+    return shard.slots[probe(shard, static_cast<uint32_t>(h), text)].symbol;
+}
+
+StringInterner::Symbol StringInterner::intern(std::string_view text) {
+    const uint64_t h = hash(text);
+    Shard& shard = shards[h >> 60];
+    {
+        std::shared_lock lock(shard.mutex);
+        if (!shard.slots.empty()) {
+            const Symbol found = shard.slots[probe(shard, static_cast<uint32_t>(h), text)].symbol;
+            if (found != none)
+                return found;
+        }
+    }
+    std::unique_lock lock(shard.mutex);
+    if ((shard.count + 1) * 4 > shard.slots.size() * 3)
+        grow(shard, std::max<size_t>(64, shard.slots.size() * 2));
+    // another thread may have stored it between the two locks
+    Slot& slot = shard.slots[probe(shard, static_cast<uint32_t>(h), text)];
+    if (slot.symbol == none) {
+        slot = {static_cast<uint32_t>(h), store(text)};
+        ++shard.count;
+    }
+    return slot.symbol;
+}
+
+void StringInterner::reserve(size_t count) {
+    for (Shard& shard : shards) {
+        std::unique_lock lock(shard.mutex);
+        // hashes spread evenly over the shards; leave room for the load factor of 3/4
+        const size_t needed = (shard.count + count / shard_count + 1) * 4 / 3 + 1;
+        if (needed > shard.slots.size())
+            grow(shard, std::bit_ceil(needed));
+    }
+}
+
+void StringInterner::grow(Shard& shard, size_t capacity) {
+    std::vector<Slot> old(capacity, Slot{0, none});
+    old.swap(shard.slots);
+    const size_t mask = shard.slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.symbol == none)
+            continue;
+        size_t i = slot.hash & mask;
+        while (shard.slots[i].symbol != none)
+            i = (i + 1) & mask;
+        shard.slots[i] = slot;
+    }
+}
+
+StringInterner::Symbol StringInterner::store(std::string_view text) {
+    const auto length = static_cast<uint32_t>(text.size());
+    const size_t needed = sizeof(length) + text.size();
+    std::lock_guard lock(arenaMutex);
+    if (used + needed > block_size) {
+        // strings that do not fit a block get a block of their own
+        if (storage.size() == max_blocks)
+            throw std::length_error("String interner is full");
+        storage.push_back(std::make_unique_for_overwrite<char[]>(std::max(needed, block_size)));
+        currentBlock = storage.size() - 1;
+        blocks[currentBlock].store(storage.back().get(), std::memory_order_release);
+        used = 0;
+    }
+    char* entry = storage[currentBlock].get() + used;
+    std::memcpy(entry, &length, sizeof(length));
+    if (length > 0)
+        std::memcpy(entry + sizeof(length), text.data(), text.size());
+    const auto symbol = static_cast<Symbol>((currentBlock << offset_bits) | used);
+    used += needed;
+    arenaBytes += needed;
+    return symbol;
+}
+
+size_t StringInterner::size() const {
+    size_t total = 0;
+    for (const Shard& shard : shards) {
+        std::shared_lock lock(shard.mutex);
+        total += shard.count;
+    }
+    return total;
+}
+
+size_t StringInterner::bytes() const {
+    std::lock_guard lock(arenaMutex);
+    return arenaBytes;
+}
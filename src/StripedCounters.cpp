@@ -0,0 +1,82 @@
+#include <StripedCounters.h>
+
+#include <algorithm>
+
+StripedCounters::Block& StripedCounters::Block::operator=(const Block& other) {
+    for (size_t shard = 0; shard < shard_count; shard++)
+        for (size_t line = 0; line < block_lines; line++)
+            for (size_t i = 0; i < per_line; i++)
+                stripes[shard][line].counts[i].store(other.stripes[shard][line].counts[i].load(std::memory_order_relaxed),
+                                                     std::memory_order_relaxed);
+    return *this;
+}
+
+void StripedCounters::resize(size_t rows) {
+    while (blocks.size() * block_rows < rows)
+        blocks.push_back(Block());
+    rowCount = rows;
+}
+
+// A pass that finds every stripe at zero proves nothing by itself: a unit can
+// be added to a stripe already passed while another is taken from one not yet
+// reached. So the stripes are read again, and the pass only counts if none of
+// them changed in between; otherwise the whole pass is retried.
+bool StripedCounters::decrement(size_t row) {
+    const size_t home = threadShard();
+    Block& cells = block(row);
+    std::array<uint64_t, shard_count> seen;
+    for (;;) {
+        for (size_t i = 0; i < shard_count; i++) {
+            std::atomic<uint64_t>& count = cell(cells, (home + i) % shard_count, row);
+            uint64_t value = count.load(std::memory_order_acquire);
+            while ((value & count_mask) > 0)
+                if (count.compare_exchange_weak(value, value + version_step - 1, std::memory_order_acquire))
+                    return true;
+            seen[i] = value;
+        }
+        size_t unchanged = 0;
+        while (unchanged < shard_count &&
+               cell(cells, (home + unchanged) % shard_count, row).load(std::memory_order_acquire) == seen[unchanged])
+            ++unchanged;
+        if (unchanged == shard_count)
+            return false;
+    }
+}
+
+// The same double read as decrement: a sum only counts if a second pass finds
+// every stripe, change counter included, as the first pass left it, which
+// proves the row held that total at one moment between the passes.
+uint64_t StripedCounters::exact(size_t row) const {
+    const Block& cells = block(row);
+    std::array<uint64_t, shard_count> seen;
+    for (;;) {
+        uint64_t total = 0;
+        for (size_t shard = 0; shard < shard_count; shard++) {
+            seen[shard] = cell(cells, shard, row).load(std::memory_order_acquire);
+            total += seen[shard] & count_mask;
+        }
+        size_t unchanged = 0;
+        while (unchanged < shard_count && cell(cells, unchanged, row).load(std::memory_order_acquire) == seen[unchanged])
+            ++unchanged;
+        if (unchanged == shard_count)
+            return total;
+    }
+}
+
+// Threads take stripes round-robin in the order they first touch a counter.
+size_t StripedCounters::threadShard() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+    return shard;
+}
+
+void StripedCounters::assign(size_t row, uint64_t value) {
+    Block& cells = block(row);
+    for (size_t shard = 0; shard < shard_count; shard++) {
+        const uint64_t part = std::min(value, count_mask);
+        std::atomic<uint64_t>& count = cell(cells, shard, row);
+        count.store(((count.load(std::memory_order_relaxed) & ~count_mask) + version_step) | part,
+                    std::memory_order_relaxed);
+        value -= part;
+    }
+}
@@ -0,0 +1,180 @@
+#include <SubscriptionGraph.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <Snapshot.h>
+
+bool SubscriptionGraph::Csr::contains(uint32_t node, uint32_t target) const {
+    const auto list = row(node);
+    return std::binary_search(list.begin(), list.end(), target);
+}
+
+bool SubscriptionGraph::inSnapshot(UserId user, ChannelId channel) const {
+    // search the shorter list; users usually follow few channels, so their row is
+    // taken without looking at the channel's, which saves a cache miss
+    const auto subscriptions = byUser->row(user);
+    if (subscriptions.size() <= short_row || subscriptions.size() <= byChannel->row(channel).size())
+        return std::binary_search(subscriptions.begin(), subscriptions.end(), channel);
+    return byChannel->contains(channel, user);
+}
+
+bool SubscriptionGraph::isSubscribed(UserId user, ChannelId channel) const {
+    const auto edited = pending->delta.find(key(user, channel));
+    if (edited != pending->delta.end())
+        return edited->second;
+    return inSnapshot(user, channel);
+}
+
+void SubscriptionGraph::record(UserId user, ChannelId channel, bool present) {
+    // cloning a hash map costs an allocation per entry; merging is a sequential
+    // pass, and leaves an empty delta for the next copy
+    if (pending.shared() && pending->delta.size() > std::max(min_compaction, edges / 64))
+        compact();
+    Pending& edits = pending.write();
+    const auto [entry, inserted] = edits.delta.try_emplace(key(user, channel), present);
+    if (inserted) {
+        edits.userEdits[user].push_back(channel);
+        edits.channelEdits[channel].push_back(user);
+    } else {
+        entry->second = present;
+    }
+    edges = present ? edges + 1 : edges - 1;
+
+    if (edits.delta.size() > std::max(min_compaction, byUser->targets.size() / 8))
+        compact();
+}
+
+bool SubscriptionGraph::subscribe(UserId user, ChannelId channel) {
+    if (isSubscribed(user, channel))
+        return false;
+    record(user, channel, true);
+    return true;
+}
+
+bool SubscriptionGraph::unsubscribe(UserId user, ChannelId channel) {
+    if (!isSubscribed(user, channel))
+        return false;
+    record(user, channel, false);
+    return true;
+}
+
+size_t SubscriptionGraph::degree(const Csr& csr, const Edits& edits, uint32_t node, bool fromUser) const {
+    const auto list = csr.row(node);
+    const auto edited = edits.find(node);
+    if (edited == edits.end())
+        return list.size();
+    std::vector<uint32_t> added, removed;
+    split(edited->second, node, fromUser, list, added, removed);
+    return list.size() + added.size() - removed.size();
+}
+
+size_t SubscriptionGraph::subscriptionCount(UserId user) const {
+    return degree(*byUser, pending->userEdits, user, true);
+}
+
+size_t SubscriptionGraph::subscriberCount(ChannelId channel) const {
+    return degree(*byChannel, pending->channelEdits, channel, false);
+}
+
+void SubscriptionGraph::split(const std::vector<uint32_t>& edited, uint32_t node, bool fromUser,
+                              std::span<const uint32_t> row, std::vector<uint32_t>& added,
+                              std::vector<uint32_t>& removed) const {
+    added.clear();
+    removed.clear();
+    for (uint32_t target : edited) {
+        const bool present = pending->delta.at(fromUser ? key(node, target) : key(target, node));
+        if (present != std::binary_search(row.begin(), row.end(), target))
+            (present ? added : removed).push_back(target);
+    }
+    std::sort(added.begin(), added.end());
+    std::sort(removed.begin(), removed.end());
+}
+
+// Rebuilds one direction in a single pass over the old snapshot: untouched
+// nodes are copied as they are, edited ones are merged with their sorted changes.
+std::shared_ptr<const SubscriptionGraph::Csr> SubscriptionGraph::merge(const Csr& csr, const Edits& edits,
+                                                                         bool fromUser) const {
+    uint32_t nodes = static_cast<uint32_t>(csr.nodes());
+    for (const auto& edited : edits)
+        nodes = std::max(nodes, edited.first + 1);
+
+    auto built = std::make_shared<Csr>();
+    std::vector<uint64_t>& offsets = built->ownOffsets;
+    std::vector<uint32_t>& targets = built->ownTargets;
+    offsets.reserve(nodes + size_t{1});
+    targets.reserve(csr.targets.size() + pending->delta.size());
+    std::vector<uint32_t> added, removed;
+    for (uint32_t node = 0; node < nodes; node++) {
+        const auto list = csr.row(node);
+        const auto edited = edits.find(node);
+        if (edited == edits.end()) {
+            targets.insert(targets.end(), list.begin(), list.end());
+        } else {
+            split(edited->second, node, fromUser, list, added, removed);
+            auto next = added.begin();
+            auto skip = removed.begin();
+            for (uint32_t target : list) {
+                for (; next != added.end() && *next < target; ++next)
+                    targets.push_back(*next);
+                if (skip != removed.end() && *skip == target)
+                    ++skip;
+                else
+                    targets.push_back(target);
+            }
+            targets.insert(targets.end(), next, added.end());
+        }
+        offsets.push_back(targets.size());
+    }
+    built->offsets = offsets;
+    built->targets = targets;
+    return built;
+}
+
+void SubscriptionGraph::compact() {
+    if (pending->delta.empty())
+        return;
+    byUser = merge(*byUser, pending->userEdits, true);
+    byChannel = merge(*byChannel, pending->channelEdits, false);
+    pending = CopyOnWrite<Pending>();
+}
+
+void SubscriptionGraph::save(SnapshotWriter& out) const {
+    std::shared_ptr<const Csr> users = pending->delta.empty() ? byUser : merge(*byUser, pending->userEdits, true);
+    out.add(SnapshotSection::subscription_user_offsets, users->offsets);
+    out.add(SnapshotSection::subscription_user_targets, users->targets);
+    users.reset();
+    const std::shared_ptr<const Csr> channels =
+        pending->delta.empty() ? byChannel : merge(*byChannel, pending->channelEdits, false);
+    out.add(SnapshotSection::subscription_channel_offsets, channels->offsets);
+    out.add(SnapshotSection::subscription_channel_targets, channels->targets);
+}
+
+void SubscriptionGraph::load(const std::shared_ptr<const Snapshot>& in, size_t users, size_t channels) {
+    auto read = [&in](SnapshotSection offsets, SnapshotSection targets, size_t nodes, size_t ids) {
+        const auto storedOffsets = in->section<uint64_t>(offsets);
+        const auto storedTargets = in->section<uint32_t>(targets);
+        if (storedOffsets.empty() || storedOffsets.size() - 1 > nodes || storedOffsets.front() != 0 ||
+            storedOffsets.back() != storedTargets.size() || !std::is_sorted(storedOffsets.begin(), storedOffsets.end()))
+            throw std::runtime_error("Damaged subscription graph in snapshot");
+        for (size_t node = 0; node + 1 < storedOffsets.size(); node++)
+            for (uint64_t i = storedOffsets[node]; i < storedOffsets[node + 1]; i++)
+                if (storedTargets[i] >= ids || (i > storedOffsets[node] && storedTargets[i - 1] >= storedTargets[i]))
+                    throw std::runtime_error("Damaged subscription graph in snapshot");
+        auto csr = std::make_shared<Csr>();
+        csr->mapping = in;
+        csr->offsets = storedOffsets;
+        csr->targets = storedTargets;
+        return csr;
+    };
+    auto following = read(SnapshotSection::subscription_user_offsets, SnapshotSection::subscription_user_targets,
+                          users, channels);
+    auto followers = read(SnapshotSection::subscription_channel_offsets, SnapshotSection::subscription_channel_targets,
+                          channels, users);
+    if (following->targets.size() != followers->targets.size())
+        throw std::runtime_error("Damaged subscription graph in snapshot");
+    edges = following->targets.size();
+    byUser = std::move(following);
+    byChannel = std::move(followers);
+    pending = CopyOnWrite<Pending>();
+}
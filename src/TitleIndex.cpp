@@ -0,0 +1,369 @@
+#include <TitleIndex.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <Snapshot.h>
+
+TitleIndex::TitleIndex()
+    : trie(1, TrieNode()), wordNodes(), postings(), wordOffset(std::vector<uint32_t>{0}), wordText(), documents(0) {}
+
+void TitleIndex::Postings::append(DocId doc) {
+    if (count % skip_interval == 0 && count > 0)
+        skips.push_back({last, static_cast<uint32_t>(bytes.size()), count});
+    uint32_t gap = count == 0 ? doc : doc - last;
+    while (gap >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(gap | 0x80));
+        gap >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(gap));
+    last = doc;
+    ++count;
+}
+
+bool TitleIndex::Cursor::next() {
+    if (index == postings->count)
+        return false;
+    uint32_t gap = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        const uint8_t byte = postings->bytes[offset++];
+        gap |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    current = index == 0 ? gap : current + gap;
+    ++index;
+    return true;
+}
+
+bool TitleIndex::Cursor::seek(DocId target) {
+    if (index > 0 && current >= target)
+        return true;
+    // jump to the last block that starts before target, if it is ahead of us
+    const auto& skips = postings->skips;
+    auto block = std::partition_point(skips.begin(), skips.end(), [target](const Skip& s) { return s.last < target; });
+    if (block != skips.begin()) {
+        --block;
+        if (block->index > index) {
+            offset = block->offset;
+            index = block->index;
+            current = block->last;
+        }
+    }
+    while (next())
+        if (current >= target)
+            return true;
+    return false;
+}
+
+// Decodes the whole list as Cursor would. Every gap must end inside the bytes
+// and every id must be below documents, with the last one equal to last. Each
+// skip must hold exactly what append would have stored at its point.
+bool TitleIndex::wellFormed(const Postings& list, DocId documents) {
+    size_t offset = 0;
+    size_t skip = 0;
+    uint64_t doc = 0;
+    for (uint32_t i = 0; i < list.count; i++) {
+        if (i % skip_interval == 0 && i > 0) {
+            if (skip == list.skips.size())
+                return false;
+            const Skip& entry = list.skips[skip++];
+            if (entry.last != doc || entry.offset != offset || entry.index != i)
+                return false;
+        }
+        uint64_t gap = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (offset == list.bytes.size() || shift > 28)
+                return false;
+            const uint8_t byte = list.bytes[offset++];
+            gap |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        // a word is posted once per title, so ids strictly increase
+        if (i > 0 && gap == 0)
+            return false;
+        doc = i == 0 ? gap : doc + gap;
+        if (doc >= documents)
+            return false;
+    }
+    return offset == list.bytes.size() && skip == list.skips.size() && (list.count == 0 || doc == list.last);
+}
+
+uint32_t TitleIndex::findNode(std::string_view prefix) const {
+    uint32_t node = 0;
+    for (char c : prefix) {
+        const auto& children = trie[node].children;
+        const auto child = std::lower_bound(children.begin(), children.end(), c,
+                                            [](const std::pair<char, uint32_t>& e, char key) { return e.first < key; });
+        if (child == children.end() || child->first != c)
+            return no_word;
+        node = child->second;
+    }
+    return node;
+}
+
+uint32_t TitleIndex::insertWord(std::string_view word) {
+    const auto known = wordNodes->find(word);
+    if (known != wordNodes->end())
+        return known->second;
+
+    uint32_t node = 0;
+    for (char c : word) {
+        const auto& children = trie[node].children;
+        const auto child = std::lower_bound(children.begin(), children.end(), c,
+                                            [](const std::pair<char, uint32_t>& e, char key) { return e.first < key; });
+        if (child == children.end() || child->first != c) {
+            const auto created = static_cast<uint32_t>(trie.size());
+            const auto at = child - children.begin();
+            // editing may clone the node, so children is not used after this
+            auto& edited = trie.edit(node).children;
+            edited.insert(edited.begin() + at, {c, created});
+            TrieNode fresh;
+            fresh.parent = node;
+            trie.push_back(fresh);
+            node = created;
+        } else {
+            node = child->second;
+        }
+    }
+    trie.edit(node).word = static_cast<uint32_t>(postings.size());
+    postings.push_back(Postings());
+    std::string& text = wordText.write();
+    text.append(word);
+    wordOffset.write().push_back(static_cast<uint32_t>(text.size()));
+    wordNodes.write().emplace(word, node);
+    return node;
+}
+
+// Document frequencies only grow, so a word that has just gained one either
+// moves up in the cached lists along its path or enters one that it now beats.
+// The path is walked from the word's own node up: a node's list is at least as
+// strong as any list below it, so once the word fails to get into one list it
+// cannot get into any list above it.
+void TitleIndex::promote(uint32_t node, uint32_t id) {
+    const uint32_t count = postings[id].count;
+    for (;;) {
+        // look before editing, so a word that stays out of a node's list does
+        // not copy a node shared with another index
+        const TrieNode& current = trie[node];
+        if (std::find(current.top.begin(), current.top.begin() + current.topCount, id) ==
+                current.top.begin() + current.topCount &&
+            current.topCount == max_suggestions && postings[current.top[max_suggestions - 1]].count >= count)
+            return;
+        TrieNode& entry = trie.edit(node);
+        auto top = entry.top.begin();
+        auto end = top + entry.topCount;
+        auto position = std::find(top, end, id);
+        if (position == end) {
+            if (entry.topCount < max_suggestions)
+                ++entry.topCount;
+            else if (postings[*(end - 1)].count >= count)
+                return;
+            end = top + entry.topCount;
+            position = end - 1;
+            *position = id;
+        }
+        for (; position != top && postings[*(position - 1)].count < count; --position)
+            std::swap(*position, *(position - 1));
+        if (node == 0)
+            return;
+        node = entry.parent;
+    }
+}
+
+TitleIndex::DocId TitleIndex::add(std::string_view title) {
+    const DocId doc = documents++;
+    forEachWord(title, [&](std::string_view word) {
+        const uint32_t node = insertWord(word);
+        const uint32_t id = trie[node].word;
+        // a word repeated in one title is posted once
+        if (postings[id].count > 0 && postings[id].last == doc)
+            return;
+        postings.edit(id).append(doc);
+        promote(node, id);
+    });
+    return doc;
+}
+
+std::vector<TitleIndex::DocId> TitleIndex::search(std::string_view query, size_t limit) const {
+    std::vector<const Postings*> lists;
+    bool missing = false;
+    forEachWord(query, [&](std::string_view word) {
+        const auto node = wordNodes->find(word);
+        if (node == wordNodes->end())
+            missing = true;
+        else
+            lists.push_back(&postings[trie[node->second].word]);
+    });
+    if (missing || lists.empty() || limit == 0)
+        return {};
+
+    // drive the intersection from the shortest list; the others only seek
+    std::sort(lists.begin(), lists.end(), [](const Postings* a, const Postings* b) { return a->count < b->count; });
+    std::vector<Cursor> cursors;
+    cursors.reserve(lists.size());
+    for (const Postings* list : lists)
+        cursors.emplace_back(*list);
+
+    // leapfrog: cursors take turns seeking to the current candidate until all of them agree on it
+    std::vector<DocId> result;
+    if (!cursors[0].next())
+        return result;
+    DocId candidate = cursors[0].doc();
+    size_t agreed = 1;
+    for (size_t turn = 1;; turn++) {
+        if (agreed == cursors.size()) {
+            result.push_back(candidate);
+            if (result.size() == limit || !cursors[0].next())
+                break;
+            candidate = cursors[0].doc();
+            agreed = 1;
+            turn = 0;
+            continue;
+        }
+        Cursor& cursor = cursors[turn % cursors.size()];
+        if (!cursor.seek(candidate))
+            break;
+        if (cursor.doc() == candidate) {
+            ++agreed;
+        } else {
+            candidate = cursor.doc();
+            agreed = 1;
+        }
+    }
+    return result;
+}
+
+std::vector<std::string_view> TitleIndex::complete(std::string_view prefix, size_t limit) const {
+    std::vector<std::string_view> result;
+    std::string lowered;
+    forEachWord(prefix, [&lowered](std::string_view word) { lowered = word; });
+    const uint32_t node = findNode(lowered);
+    if (node == no_word)
+        return result;
+    const TrieNode& found = trie[node];
+    for (size_t i = 0; i < found.topCount && result.size() < limit; i++)
+        result.push_back(wordOf(found.top[i]));
+    return result;
+}
+
+namespace {
+    struct StoredNode {
+        uint32_t parent;
+        uint32_t word;
+        uint32_t topCount;
+        std::array<uint32_t, TitleIndex::max_suggestions> top;
+    };
+
+    struct StoredChild {
+        uint32_t byte;
+        uint32_t node;
+    };
+
+    struct StoredPostings {
+        uint32_t last;
+        uint32_t count;
+        uint64_t bytes;  // lengths of the list's slices of the concatenated bytes and skips
+        uint64_t skips;
+    };
+}
+
+void TitleIndex::save(SnapshotWriter& out) const {
+    std::vector<StoredNode> nodes;
+    std::vector<uint64_t> childOffsets{0};
+    std::vector<StoredChild> children;
+    nodes.reserve(trie.size());
+    childOffsets.reserve(trie.size() + 1);
+    trie.forEach([&](const TrieNode& node) {
+        nodes.push_back({node.parent, node.word, node.topCount, node.top});
+        for (const auto& [byte, child] : node.children)
+            children.push_back({static_cast<unsigned char>(byte), child});
+        childOffsets.push_back(children.size());
+    });
+    out.add(SnapshotSection::title_index_nodes, nodes);
+    out.add(SnapshotSection::title_index_child_offsets, childOffsets);
+    out.add(SnapshotSection::title_index_children, children);
+
+    std::vector<StoredPostings> lists;
+    std::vector<uint8_t> bytes;
+    std::vector<Skip> skips;
+    lists.reserve(postings.size());
+    postings.forEach([&](const Postings& list) {
+        lists.push_back({list.last, list.count, list.bytes.size(), list.skips.size()});
+        bytes.insert(bytes.end(), list.bytes.begin(), list.bytes.end());
+        skips.insert(skips.end(), list.skips.begin(), list.skips.end());
+    });
+    out.add(SnapshotSection::title_index_postings, lists);
+    out.add(SnapshotSection::title_index_posting_bytes, bytes);
+    out.add(SnapshotSection::title_index_skips, skips);
+
+    out.add(SnapshotSection::title_index_word_offsets, *wordOffset);
+    out.add(SnapshotSection::title_index_word_bytes, std::string_view(*wordText));
+    const std::array<uint64_t, 1> meta{documents};
+    out.add(SnapshotSection::title_index_meta, std::span<const uint64_t>(meta));
+}
+
+void TitleIndex::load(const Snapshot& in) {
+    const auto nodes = in.section<StoredNode>(SnapshotSection::title_index_nodes);
+    const auto childOffsets = in.section<uint64_t>(SnapshotSection::title_index_child_offsets);
+    const auto children = in.section<StoredChild>(SnapshotSection::title_index_children);
+    const auto lists = in.section<StoredPostings>(SnapshotSection::title_index_postings);
+    const auto bytes = in.section<uint8_t>(SnapshotSection::title_index_posting_bytes);
+    const auto skips = in.section<Skip>(SnapshotSection::title_index_skips);
+    const auto offsets = in.section<uint32_t>(SnapshotSection::title_index_word_offsets);
+    const auto text = in.bytes(SnapshotSection::title_index_word_bytes);
+    const auto meta = in.section<uint64_t>(SnapshotSection::title_index_meta);
+    if (nodes.empty() || childOffsets.size() != nodes.size() + 1 || childOffsets.front() != 0 ||
+        childOffsets.back() != children.size() || !std::is_sorted(childOffsets.begin(), childOffsets.end()) ||
+        offsets.size() != lists.size() + 1 || offsets.front() != 0 || offsets.back() != text.size() ||
+        !std::is_sorted(offsets.begin(), offsets.end()) || meta.size() != 1 || meta[0] > UINT32_MAX)
+        throw std::runtime_error("Damaged title index in snapshot");
+    const auto documentCount = static_cast<DocId>(meta[0]);
+
+    trie = PersistentVector<TrieNode, 32>(nodes.size(), TrieNode());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if ((nodes[i].word != no_word && nodes[i].word >= lists.size()) || nodes[i].parent >= nodes.size() ||
+            std::any_of(nodes[i].top.begin(), nodes[i].top.begin() + std::min<uint32_t>(nodes[i].topCount, max_suggestions),
+                        [&](uint32_t word) { return word >= lists.size(); }))
+            throw std::runtime_error("Damaged title index in snapshot");
+        TrieNode& node = trie.edit(i);
+        node.parent = nodes[i].parent;
+        node.word = nodes[i].word;
+        node.topCount = static_cast<uint8_t>(std::min<uint32_t>(nodes[i].topCount, max_suggestions));
+        node.top = nodes[i].top;
+        node.children.reserve(childOffsets[i + 1] - childOffsets[i]);
+        for (uint64_t c = childOffsets[i]; c < childOffsets[i + 1]; c++) {
+            if (children[c].node >= nodes.size())
+                throw std::runtime_error("Damaged title index in snapshot");
+            node.children.emplace_back(static_cast<char>(children[c].byte), children[c].node);
+        }
+    }
+
+    postings = PersistentVector<Postings, 8>(lists.size(), Postings());
+    uint64_t byteOffset = 0, skipOffset = 0;
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (lists[i].bytes > bytes.size() - byteOffset || lists[i].skips > skips.size() - skipOffset)
+            throw std::runtime_error("Damaged title index in snapshot");
+        Postings& list = postings.edit(i);
+        list.bytes.assign(bytes.begin() + static_cast<std::ptrdiff_t>(byteOffset),
+                          bytes.begin() + static_cast<std::ptrdiff_t>(byteOffset + lists[i].bytes));
+        list.skips.assign(skips.begin() + static_cast<std::ptrdiff_t>(skipOffset),
+                          skips.begin() + static_cast<std::ptrdiff_t>(skipOffset + lists[i].skips));
+        list.last = lists[i].last;
+        list.count = lists[i].count;
+        if (!wellFormed(list, documentCount))
+            throw std::runtime_error("Damaged title index in snapshot");
+        byteOffset += lists[i].bytes;
+        skipOffset += lists[i].skips;
+    }
+
+    wordOffset.write().assign(offsets.begin(), offsets.end());
+    wordText.write().assign(text);
+    documents = documentCount;
+    WordNodes& words = wordNodes.write();
+    words.clear();
+    words.reserve(postings.size());
+    for (uint32_t node = 0; node < trie.size(); node++)
+        if (trie[node].word != no_word)
+            words.emplace(wordOf(trie[node].word), node);
+}
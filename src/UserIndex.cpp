@@ -0,0 +1,206 @@
+#include <UserIndex.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <Snapshot.h>
+
+namespace {
+    constexpr size_t initial_capacity = 16;
+
+    uint64_t load64(const char* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint64_t fmix64(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+}
+
+UserIndex::UserIndex() : slots(initial_capacity, Slot{0, npos, 0, {}}), keyPool(), mask(initial_capacity - 1), count(0) {}
+
+// Eight bytes per multiply; usernames are short, so this is a handful of instructions.
+uint64_t UserIndex::hash(std::string_view name) {
+    const char* p = name.data();
+    size_t n = name.size();
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (n * 0x87c37b91114253d5ULL);
+    for (; n >= 8; n -= 8, p += 8)
+        h = (h ^ fmix64(load64(p))) * 0x9e3779b97f4a7c15ULL;
+    if (n) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, p, n);
+        h = (h ^ fmix64(tail)) * 0x9e3779b97f4a7c15ULL;
+    }
+    return fmix64(h);
+}
+
+std::string_view UserIndex::keyOf(const Slot& slot, std::string_view pool) {
+    if (slot.length <= inline_key_size)
+        return {slot.key, slot.length};
+    uint64_t offset;
+    std::memcpy(&offset, slot.key, sizeof(offset));
+    return {pool.data() + offset, slot.length};
+}
+
+template<typename Slots>
+uint32_t UserIndex::probe(const Slots& table, size_t mask, std::string_view pool, uint64_t h, std::string_view name) {
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        const Slot& slot = table[i];
+        if (slot.value == npos)
+            return npos;
+        if (slot.hash == h && slot.length == name.size() && keyOf(slot, pool) == name)
+            return slot.value;
+    }
+}
+
+uint32_t UserIndex::find(std::string_view name) const {
+    const uint64_t h = hash(name);
+    if (!mappedSlots.empty()) {
+        const uint32_t found = probe(mappedSlots, mappedSlots.size() - 1, mappedKeys, h, name);
+        if (found != npos)
+            return found;
+    }
+    return probe(slots, mask, *keyPool, h, name);
+}
+
+bool UserIndex::insert(std::string_view name, uint32_t value) {
+    const uint64_t h = hash(name);
+    if (!mappedSlots.empty() && probe(mappedSlots, mappedSlots.size() - 1, mappedKeys, h, name) != npos)
+        return false;
+    // keep the load factor at or below 3/4 so probe sequences stay short
+    if ((count + 1) * 4 > slots.size() * 3)
+        grow();
+
+    size_t i = h & mask;
+    for (;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.value == npos)
+            break;
+        if (slot.hash == h && slot.length == name.size() && keyOf(slot, *keyPool) == name)
+            return false;
+    }
+
+    Slot& slot = slots.edit(i);
+    slot.hash = h;
+    slot.value = value;
+    slot.length = static_cast<uint32_t>(name.size());
+    if (name.size() <= inline_key_size) {
+        std::memcpy(slot.key, name.data(), name.size());
+    } else {
+        std::string& pool = keyPool.write();
+        const uint64_t offset = pool.size();
+        pool.append(name);
+        std::memcpy(slot.key, &offset, sizeof(offset));
+    }
+    ++count;
+    return true;
+}
+
+void UserIndex::reserve(size_t n) {
+    // the saved slots hold their own names
+    n = n > mappedCount ? n - mappedCount : 0;
+    size_t capacity = slots.size();
+    while (n * 4 > capacity * 3)
+        capacity *= 2;
+    if (capacity != slots.size())
+        rehash(capacity);
+}
+
+void UserIndex::grow() {
+    rehash(slots.size() * 2);
+}
+
+// Stored hashes are reused, so moving to a bigger table reads no key bytes.
+void UserIndex::rehash(size_t capacity) {
+    PersistentVector<Slot, 2048> old(capacity, Slot{0, npos, 0, {}});
+    std::swap(old, slots);
+    mask = capacity - 1;
+    old.forEach([&](const Slot& slot) {
+        if (slot.value == npos)
+            return;
+        size_t i = slot.hash & mask;
+        while (slots[i].value != npos)
+            i = (i + 1) & mask;
+        slots.edit(i) = slot;
+    });
+}
+
+// After a load the two tables are merged into one, in a slot array large
+// enough for both; the names of the saved one keep their place in the pool.
+void UserIndex::save(SnapshotWriter& out) const {
+    std::vector<Slot> flat;
+    std::string merged;
+    std::string_view keys = *keyPool;
+    if (mappedSlots.empty()) {
+        flat.reserve(slots.size());
+        slots.forEachChunk([&](std::span<const Slot> chunk) { flat.insert(flat.end(), chunk.begin(), chunk.end()); });
+    } else {
+        size_t capacity = std::max(mappedSlots.size(), slots.size());
+        while (size() * 4 > capacity * 3)
+            capacity *= 2;
+        flat.assign(capacity, Slot{0, npos, 0, {}});
+        const auto place = [&](Slot slot, uint64_t shift) {
+            if (slot.value == npos)
+                return;
+            if (slot.length > inline_key_size) {
+                uint64_t offset;
+                std::memcpy(&offset, slot.key, sizeof(offset));
+                offset += shift;
+                std::memcpy(slot.key, &offset, sizeof(offset));
+            }
+            size_t i = slot.hash & (capacity - 1);
+            while (flat[i].value != npos)
+                i = (i + 1) & (capacity - 1);
+            flat[i] = slot;
+        };
+        for (const Slot& slot : mappedSlots)
+            place(slot, 0);
+        slots.forEach([&](const Slot& slot) { place(slot, mappedKeys.size()); });
+        merged = std::string(mappedKeys) + *keyPool;
+        keys = merged;
+    }
+    out.add(SnapshotSection::user_index_slots, flat);
+    out.add(SnapshotSection::user_index_keys, keys);
+    const std::array<uint64_t, 1> meta{size()};
+    out.add(SnapshotSection::user_index_meta, std::span<const uint64_t>(meta));
+}
+
+void UserIndex::load(std::shared_ptr<const Snapshot> in, size_t values) {
+    const auto stored = in->section<Slot>(SnapshotSection::user_index_slots);
+    const auto meta = in->section<uint64_t>(SnapshotSection::user_index_meta);
+    const auto keys = in->bytes(SnapshotSection::user_index_keys);
+    // within the load factor, so a probe always ends at an empty slot
+    if (stored.empty() || (stored.size() & (stored.size() - 1)) != 0 || meta.size() != 1 ||
+        meta[0] * 4 > stored.size() * 3)
+        throw std::runtime_error("Damaged user index in snapshot");
+    size_t occupied = 0;
+    for (const Slot& slot : stored) {
+        if (slot.value == npos)
+            continue;
+        ++occupied;
+        uint64_t offset = 0;
+        if (slot.length > inline_key_size)
+            std::memcpy(&offset, slot.key, sizeof(offset));
+        if (slot.value >= values || (slot.length > inline_key_size && (offset > keys.size() || slot.length > keys.size() - offset)))
+            throw std::runtime_error("Damaged user index in snapshot");
+    }
+    if (occupied != meta[0])
+        throw std::runtime_error("Damaged user index in snapshot");
+    mapping = std::move(in);
+    mappedSlots = stored;
+    mappedKeys = keys;
+    mappedCount = meta[0];
+    slots = PersistentVector<Slot, 2048>(initial_capacity, Slot{0, npos, 0, {}});
+    keyPool = CopyOnWrite<std::string>();
+    mask = initial_capacity - 1;
+    count = 0;
+}
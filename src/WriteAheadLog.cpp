@@ -0,0 +1,254 @@
+#include <WriteAheadLog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <digestpp.hpp>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    log_format::Checksum checksum(const log_format::RecordHeader& header, std::initializer_list<std::string_view> payload) {
+        digestpp::blake2b hash(8 * sizeof(log_format::Checksum));
+        hash.absorb(reinterpret_cast<const unsigned char*>(&header.size), sizeof(header.size));
+        hash.absorb(reinterpret_cast<const unsigned char*>(&header.type), sizeof(header.type));
+        hash.absorb(reinterpret_cast<const unsigned char*>(&header.sequence), sizeof(header.sequence));
+        for (auto part : payload)
+            if (!part.empty())
+                hash.absorb(reinterpret_cast<const unsigned char*>(part.data()), part.size());
+        return hash.digest<sizeof(log_format::Checksum)>();
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return {};
+        std::string contents(static_cast<size_t>(std::filesystem::file_size(path)), '\0');
+        file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+        contents.resize(static_cast<size_t>(file.gcount()));
+        return contents;
+    }
+
+    // Walks the records after the file header, calling apply for those after
+    // `after`. Returns the offset just past the last intact record.
+    size_t scan(std::string_view file, WriteAheadLog::Sequence after, WriteAheadLog::Sequence& last,
+                const std::function<void(const WriteAheadLog::Record&)>* apply) {
+        size_t offset = sizeof(log_format::Header);
+        last = 0;
+        while (file.size() - offset >= sizeof(log_format::RecordHeader)) {
+            log_format::RecordHeader header{};
+            std::memcpy(&header, file.data() + offset, sizeof(header));
+            if (header.size > log_format::max_payload ||
+                header.size > file.size() - offset - sizeof(header) ||
+                header.sequence <= last)
+                break;
+            const std::string_view payload = file.substr(offset + sizeof(header), header.size);
+            if (checksum(header, {payload}) != header.checksum)
+                break;
+            if (apply && header.sequence > after)
+                (*apply)({header.sequence, static_cast<LogRecordType>(header.type), payload});
+            last = header.sequence;
+            offset += sizeof(header) + header.size;
+        }
+        return offset;
+    }
+
+    [[noreturn]] void fail(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const WriteAheadLog::Stats& stats) {
+    const double rate = stats.seconds > 0 ? static_cast<double>(stats.fsyncs) / stats.seconds : 0.0;
+    os << "wal records=" << stats.records << " bytes=" << stats.bytes << " fsyncs=" << stats.fsyncs
+       << " fsyncs_per_sec=" << static_cast<uint64_t>(rate) << '\n';
+    os << "wal.commit " << stats.commit << '\n';
+    return os;
+}
+
+WriteAheadLog::WriteAheadLog(std::filesystem::path logPath)
+    : path(std::move(logPath)), opened(std::chrono::steady_clock::now()) {
+    const std::string contents = readFile(path);
+    const bool fresh = contents.empty();
+    if (!fresh) {
+        log_format::Header header{};
+        if (contents.size() >= sizeof(header))
+            std::memcpy(&header, contents.data(), sizeof(header));
+        if (contents.size() < sizeof(header) || header.magic != log_format::magic ||
+            header.byteOrder != log_format::byte_order)
+            throw std::runtime_error("Not a write-ahead log: " + path.string());
+        if (header.version != log_format::version)
+            throw std::runtime_error("Unsupported write-ahead log version in " + path.string());
+        const size_t end = scan(contents, 0, appended, nullptr);
+        if (end < contents.size())
+            std::filesystem::resize_file(path, end);
+        durable = appended;
+    }
+
+#ifdef _WIN32
+    fd = _wopen(path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+#endif
+    if (fd < 0)
+        fail("Could not open write-ahead log " + path.string());
+
+    if (fresh) {
+        log_format::Header header{log_format::magic, log_format::version, log_format::byte_order};
+        try {
+            writeOut(std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+#ifndef _WIN32
+            // make the new directory entry durable too
+            const std::filesystem::path parent = path.parent_path().empty() ? "." : path.parent_path();
+            const int directory = ::open(parent.c_str(), O_RDONLY | O_DIRECTORY);
+            if (directory < 0 || ::fsync(directory) != 0) {
+                if (directory >= 0)
+                    ::close(directory);
+                fail("Could not flush directory of " + path.string());
+            }
+            ::close(directory);
+#endif
+        } catch (...) {
+#ifdef _WIN32
+            _close(fd);
+#else
+            ::close(fd);
+#endif
+            throw;
+        }
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    try {
+        sync();
+    } catch (...) {
+        // a failed log has already reported the error to sync()'s callers
+    }
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+void WriteAheadLog::replay(Sequence after, const std::function<void(const Record&)>& apply) const {
+    const std::string contents = readFile(path);
+    if (contents.size() < sizeof(log_format::Header))
+        return;
+    Sequence last = 0;
+    scan(contents, after, last, &apply);
+}
+
+WriteAheadLog::Sequence WriteAheadLog::append(LogRecordType type, std::initializer_list<std::string_view> payload) {
+    log_format::RecordHeader header{};
+    for (auto part : payload)
+        header.size += static_cast<uint32_t>(part.size());
+    if (header.size > log_format::max_payload)
+        throw std::length_error("Write-ahead log record too large");
+    header.type = static_cast<uint16_t>(type);
+
+    const std::lock_guard lock(mutex);
+    header.sequence = ++appended;
+    header.checksum = checksum(header, payload);
+    pending.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (auto part : payload)
+        pending.append(part);
+    ++counters.records;
+    counters.bytes += sizeof(header) + header.size;
+    return header.sequence;
+}
+
+void WriteAheadLog::continueAfter(Sequence sequence) {
+    const std::lock_guard lock(mutex);
+    if (appended < sequence && pending.empty() && !flushing)
+        appended = durable = sequence;
+}
+
+void WriteAheadLog::sync(Sequence upTo) {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock lock(mutex);
+    upTo = std::min(upTo, appended);
+    while (durable < upTo) {
+        if (failure)
+            std::rethrow_exception(failure);
+        if (flushing) {
+            flushed.wait(lock);
+            continue;
+        }
+        // become the leader: take everything buffered so far and flush it unlocked
+        flushing = true;
+        std::string batch;
+        batch.swap(pending);
+        const Sequence end = appended;
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            writeOut(batch);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        flushing = false;
+        if (error)
+            failure = error;
+        else {
+            durable = end;
+            ++counters.fsyncs;
+        }
+        flushed.notify_all();
+    }
+    counters.commit.record(std::chrono::steady_clock::now() - start);
+}
+
+void WriteAheadLog::writeOut(const std::string& batch) {
+    size_t written = 0;
+    while (written < batch.size()) {
+#ifdef _WIN32
+        const int count = _write(fd, batch.data() + written, static_cast<unsigned>(batch.size() - written));
+#else
+        const ssize_t count = ::write(fd, batch.data() + written, batch.size() - written);
+        if (count < 0 && errno == EINTR)
+            continue;
+#endif
+        if (count < 0)
+            fail("Could not write write-ahead log " + path.string());
+        written += static_cast<size_t>(count);
+    }
+#if defined(_WIN32)
+    const bool synced = _commit(fd) == 0;
+#elif defined(__linux__)
+    const bool synced = ::fdatasync(fd) == 0;
+#else
+    const bool synced = ::fsync(fd) == 0;
+#endif
+    if (!synced)
+        fail("Could not flush write-ahead log " + path.string());
+}
+
+WriteAheadLog::Sequence WriteAheadLog::lastAppended() const {
+    const std::lock_guard lock(mutex);
+    return appended;
+}
+
+WriteAheadLog::Sequence WriteAheadLog::lastDurable() const {
+    const std::lock_guard lock(mutex);
+    return durable;
+}
+
+WriteAheadLog::Stats WriteAheadLog::stats() const {
+    const std::lock_guard lock(mutex);
+    Stats copy = counters;
+    copy.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - opened).count();
+    return copy;
+}
@@ -0,0 +1,82 @@
+// Assigning to an App that logs its mutations: the assignment must not drop the
+// log silently. It throws while a log is attached, leaving the App and its log
+// as they were, so later mutations are still appended; once the log is detached
+// the assignment goes through, and a log attached afterwards records, and
+// replays, the mutations made to the new state.
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <App.h>
+#include <WriteAheadLog.h>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    int failures = 0;
+
+    void expect(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAIL %s\n", what);
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    // App says goodbye on std::cout
+    std::cout.setstate(std::ios::failbit);
+    const fs::path directory = fs::temp_directory_path() / "oop_app_assign";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    App other;
+    other.addUser("bob");
+    other.addUser("carol");
+
+    {
+        WriteAheadLog wal(directory / "logged.wal");
+        App app;
+        app.attachLog(wal);
+        app.addUser("alice");
+        const auto before = wal.lastAppended();
+        bool threw = false;
+        try {
+            app = other;
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        expect(threw, "assignment with a log attached throws");
+        expect(app.findUser("alice") && !app.findUser("bob"), "failed assignment leaves the App as it was");
+        app.addUser("dave");
+        expect(wal.lastAppended() == before + 1, "mutation after the failed assignment is logged");
+        expect(app.loggedThrough() == wal.lastAppended(), "log still attached");
+
+        app.detachLog();
+        app = other;
+        expect(app.findUser("bob") && !app.findUser("alice"), "assignment after detaching");
+        app.detachLog();
+    }
+
+    {
+        App app;
+        app = other;
+        {
+            WriteAheadLog fresh(directory / "fresh.wal");
+            app.attachLog(fresh);
+            app.addUser("erin");
+            expect(fresh.lastAppended() == 1, "mutation after the assignment is logged");
+            fresh.sync();
+            app.detachLog();
+        }
+        WriteAheadLog reopened(directory / "fresh.wal");
+        App rebuilt(other);
+        rebuilt.attachLog(reopened);
+        expect(rebuilt.findUser("erin") && rebuilt.findUser("bob"), "logged mutation replays onto the assigned state");
+        rebuilt.detachLog();
+    }
+
+    fs::remove_all(directory);
+    std::printf("%s\n", failures ? "FAILED" : "assignment keeps the log honest");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+// A music channel rebuilt from its write-ahead log: every song, playlist and
+// favorite change is logged once, changes that do nothing are not logged, and
+// replaying the log into a fresh channel gives the same songs, playlist order,
+// favorites, subscriber count and search results as the original. A snapshot
+// of the channel loads back the same way, label included, and takes changes.
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <Channel.h>
+#include <OutputBuffer.h>
+#include <Snapshot.h>
+#include <User.h>
+#include <WriteAheadLog.h>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    int failures = 0;
+
+    void expect(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAIL %s\n", what);
+            ++failures;
+        }
+    }
+
+    std::string render(const MusicChannel& music) {
+        std::ostringstream os;
+        {
+            OutputBuffer out(os);
+            out << music << '\n';
+            music.displaySongs(out);
+            music.displayPlaylist(out);
+            music.displayFavorites(out);
+        }
+        for (const auto& song : music.searchSongs("blue"))
+            os << "found " << song << '\n';
+        return os.str();
+    }
+
+    // Runs one change and checks that it logged exactly when it did something.
+    template<typename F>
+    void change(WriteAheadLog& wal, const char* what, bool expected, F f) {
+        const auto before = wal.lastAppended();
+        const bool changed = f();
+        expect(changed == expected, what);
+        expect(wal.lastAppended() == before + (changed ? 1 : 0), what);
+    }
+}
+
+int main() {
+    const fs::path directory = fs::temp_directory_path() / "oop_playlist_replay";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    const fs::path path = directory / "music.wal";
+    const fs::path snapshotPath = directory / "music.snap";
+    User owner("dj");
+
+    std::string expected;
+    {
+        WriteAheadLog wal(path);
+        MusicChannel music("radio", &owner);
+        music.attachLog(&wal);
+        for (const char* song : {"Blue Monday", "Red Light", "Green Onions", "Kind of Blue", "Yellow"})
+            music.addSong(song);
+        music.subscribe();
+        music.subscribe();
+        music.unsubscribe();
+        music.publishVideo("live at the studio");
+
+        change(wal, "add to playlist", true, [&] { return music.addToPlaylist("Red Light"); });
+        change(wal, "add another", true, [&] { return music.addToPlaylist("Yellow"); });
+        change(wal, "add a third", true, [&] { return music.addToPlaylist("Blue Monday"); });
+        change(wal, "add a duplicate", false, [&] { return music.addToPlaylist("Yellow"); });
+        change(wal, "add a song never uploaded", true, [&] { return music.addToPlaylist("Unreleased"); });
+        change(wal, "insert at the front", true, [&] { return music.insertIntoPlaylist("Green Onions", 0); });
+        change(wal, "move inside", true, [&] { return music.moveInPlaylist("Blue Monday", 1); });
+        change(wal, "move past the end", true, [&] { return music.moveInPlaylist("Green Onions", 100); });
+        change(wal, "move a missing song", false, [&] { return music.moveInPlaylist("Kind of Blue", 0); });
+        change(wal, "remove", true, [&] { return music.removeFromPlaylist("Red Light"); });
+        change(wal, "remove a missing song", false, [&] { return music.removeFromPlaylist("Red Light"); });
+        change(wal, "mark favorite", true, [&] { return music.markFavorite("Yellow"); });
+        change(wal, "mark another", true, [&] { return music.markFavorite("Blue Monday"); });
+        change(wal, "mark twice", false, [&] { return music.markFavorite("Yellow"); });
+        change(wal, "mark a song off the playlist", false, [&] { return music.markFavorite("Kind of Blue"); });
+        change(wal, "unmark", true, [&] { return music.unmarkFavorite("Yellow"); });
+        change(wal, "unmark twice", false, [&] { return music.unmarkFavorite("Yellow"); });
+
+        music.setLabel("Factory");
+        expected = render(music);
+        music.saveSnapshot(snapshotPath);
+        wal.sync();
+        music.attachLog(nullptr);
+    }
+
+    {
+        WriteAheadLog wal(path);
+        MusicChannel rebuilt("radio", &owner);
+        rebuilt.attachLog(&wal);
+        rebuilt.replay(wal);
+        const std::string replayed = render(rebuilt);
+        expect(replayed == expected, "replayed channel matches the original");
+        if (replayed != expected)
+            std::printf("expected:\n%s\nreplayed:\n%s\n", expected.c_str(), replayed.c_str());
+        // replay appends nothing, and logging carries on afterwards
+        const auto last = wal.lastAppended();
+        rebuilt.replay(wal, last);
+        expect(wal.lastAppended() == last, "replay logs nothing");
+        change(wal, "log after replay", true, [&] { return rebuilt.markFavorite("Green Onions"); });
+        rebuilt.attachLog(nullptr);
+    }
+
+    {
+        MusicChannel loaded(std::make_shared<const Snapshot>(snapshotPath), &owner);
+        const std::string restored = render(loaded);
+        expect(restored == expected, "channel loaded from its snapshot matches the original");
+        if (restored != expected)
+            std::printf("expected:\n%s\nloaded:\n%s\n", expected.c_str(), restored.c_str());
+        expect(loaded.getLabel() == "Factory", "label loaded");
+        expect(loaded.isFavorite("Blue Monday") && !loaded.isFavorite("Yellow"), "favorites loaded");
+        expect(!loaded.addToPlaylist("Yellow") && loaded.addToPlaylist("Kind of Blue"), "loaded playlist takes changes");
+        loaded.publishVideo("encore");
+        expect(loaded.getChannelName() == "radio" && loaded.getSubscriberCount() == 1, "table row loaded");
+    }
+
+    fs::remove_all(directory);
+    std::printf("%s\n", failures ? "FAILED" : "replayed playlist matches");
+    return failures ? 1 : 0;
+}
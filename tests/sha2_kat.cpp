@@ -0,0 +1,88 @@
+// SHA-224 and SHA-256 against known answers: the FIPS 180-4 examples plus
+// messages around the padding boundaries (55, 56 and 64 bytes and their
+// neighbours) and across several blocks, hashed whole and in pieces. Built
+// twice, once with the SHA-NI transform when the CPU has it and once with
+// DIGESTPP_NO_SIMD, so both compression paths are checked.
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <digestpp.hpp>
+
+namespace {
+    struct Vector {
+        std::string message;
+        std::string_view sha224;
+        std::string_view sha256;
+    };
+
+    int failures = 0;
+
+    template<typename H>
+    void check(const char* algorithm, const Vector& v, std::string_view expected) {
+        const std::string whole = H().absorb(v.message).hexdigest();
+        if (whole != expected) {
+            std::printf("FAIL %s, %zu bytes: %s, expected %s\n", algorithm, v.message.size(), whole.c_str(),
+                        std::string(expected).c_str());
+            ++failures;
+        }
+        // short messages again, split at every offset up to two blocks in, so
+        // buffered tails meet whole blocks at each alignment
+        for (size_t split = 1; v.message.size() <= 1024 && split < v.message.size() && split <= 128; split++) {
+            H h;
+            h.absorb(v.message.data(), split);
+            h.absorb(v.message.data() + split, v.message.size() - split);
+            if (h.hexdigest() != expected) {
+                std::printf("FAIL %s, %zu bytes split at %zu\n", algorithm, v.message.size(), split);
+                ++failures;
+                return;
+            }
+        }
+    }
+}
+
+int main() {
+    const Vector vectors[] = {
+        // FIPS 180-4 examples
+        {"abc", "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7",
+         "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+         "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525",
+         "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+         "c97ca9a559850ce97a04a96def6d99a9e0e0e2ab14e6b8df265fc0b3",
+         "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+        {std::string(1000000, 'a'), "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67",
+         "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+        // padding edges: 55 bytes is the longest message whose length fits in its
+        // last block, 56 the shortest that needs another; 64 is a whole block
+        {"", "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f",
+         "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {std::string(55, 'a'), "fb0bd626a70c28541dfa781bb5cc4d7d7f56622a58f01a0b1ddd646f",
+         "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318"},
+        {std::string(56, 'a'), "d40854fc9caf172067136f2e29e1380b14626bf6f0dd06779f820dcd",
+         "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a"},
+        {std::string(57, 'a'), "b5d09534784ab6578128bce7f28a96a56e3b45c4f734f74739076249",
+         "f13b2d724659eb3bf47f2dd6af1accc87b81f09f59f2b75e5c0bed6589dfe8c6"},
+        {std::string(63, 'a'), "1d4e051f4d6fed2a63fd2421e65834cec00d64456553de3496ae8b1d",
+         "7d3e74a05d7db15bce4ad9ec0658ea98e3f06eeecf16b4c6fff2da457ddc2f34"},
+        {std::string(64, 'a'), "a88cd5cde6d6fe9136a4e58b49167461ea95d388ca2bdb7afdc3cbf4",
+         "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb"},
+        {std::string(65, 'a'), "ff8716f600af42959d0efb52e1f21b01bb328733009344d511c299fb",
+         "635361c48bb9eab14198e76ea8ab7f1a41685d6ad62aa9146d301d4f17eb0ae0"},
+        {std::string(119, 'a'), "e000e6709d26667b631faa7fc1bd404eb4774003c5fb4f51a0184875",
+         "31eba51c313a5c08226adf18d4a359cfdfd8d2e816b13f4af952f7ea6584dcfb"},
+        {std::string(120, 'a'), "66924e30a9929327e7a6cf03747397226ed2efc180ebe3dea7132a79",
+         "2f3d335432c70b580af0e8e1b3674a7c020d683aa5f73aaaedfdc55af904c21c"},
+        {std::string(128, 'a'), "39873a2441c56608137850f4c54dde157710b9a2b83c8bdc756dd643",
+         "6836cf13bac400e9105071cd6af47084dfacad4e5e302c94bfed24e013afb73e"},
+    };
+
+    const auto& cpu = digestpp::detail::cpu();
+    std::printf("SHA-256 transform: %s\n", cpu.sha && cpu.sse41 ? "SHA-NI" : "scalar");
+    for (const auto& v : vectors) {
+        check<digestpp::sha224>("SHA-224", v, v.sha224);
+        check<digestpp::sha256>("SHA-256", v, v.sha256);
+    }
+    std::printf("%s\n", failures ? "FAILED" : "all vectors match");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+// ShardedApp subscriptions changed from many threads at once: users and
+// channels are spread over every shard, so most changes hold two shard locks,
+// taken in both directions between the same pairs. When the threads are done,
+// every channel's counter must equal the number of users subscribed to it, and
+// the successful subscribes less unsubscribes must add up to the total.
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ShardedApp.h>
+
+namespace {
+    constexpr size_t shard_count = 8;
+    constexpr size_t user_count = 400;
+    constexpr size_t channel_count = 40;
+    constexpr size_t thread_count = 8;
+    constexpr size_t changes_per_thread = 20000;
+}
+
+int main() {
+    ShardedApp app(shard_count);
+    const PasswordManager::Digest digest{};
+    const PasswordManager::Salt salt{};
+    std::vector<std::string> names;
+    for (size_t i = 0; i < user_count; i++) {
+        names.push_back("user" + std::to_string(i));
+        app.addUser(names.back(), digest, salt);
+    }
+    std::vector<ShardedApp::ChannelId> channels;
+    for (size_t i = 0; i < channel_count; i++)
+        channels.push_back(app.addChannel("channel" + std::to_string(i), names[i * 10]));
+
+    std::atomic<int64_t> net{0};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> overflow{false};
+    // a reader of the counters while they change
+    std::jthread reader([&] {
+        while (!stop.load(std::memory_order_relaxed))
+            for (const auto channel : channels)
+                if (app.subscribers(channel) > user_count)
+                    overflow.store(true, std::memory_order_relaxed);
+    });
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < thread_count; t++)
+            workers.emplace_back([&, t] {
+                std::mt19937_64 random(t + 1);
+                int64_t mine = 0;
+                for (size_t i = 0; i < changes_per_thread; i++) {
+                    const std::string& user = names[random() % user_count];
+                    const auto channel = channels[random() % channel_count];
+                    if (random() % 2)
+                        mine += app.subscribe(user, channel);
+                    else
+                        mine -= app.unsubscribe(user, channel);
+                }
+                net.fetch_add(mine, std::memory_order_relaxed);
+            });
+    }
+    stop.store(true, std::memory_order_relaxed);
+    reader.join();
+
+    int failures = 0;
+    uint64_t total = 0;
+    for (const auto channel : channels) {
+        uint64_t edges = 0;
+        for (const auto& name : names)
+            edges += app.isSubscribed(name, channel);
+        total += edges;
+        if (app.subscribers(channel) != edges) {
+            std::printf("FAIL %s: %llu subscribers counted, %llu subscribed\n", app.channelName(channel).c_str(),
+                        static_cast<unsigned long long>(app.subscribers(channel)),
+                        static_cast<unsigned long long>(edges));
+            ++failures;
+        }
+    }
+    if (static_cast<int64_t>(total) != net.load()) {
+        std::printf("FAIL %llu edges, but the changes net %lld\n", static_cast<unsigned long long>(total),
+                    static_cast<long long>(net.load()));
+        ++failures;
+    }
+    if (overflow.load()) {
+        std::printf("FAIL a counter read above the number of users\n");
+        ++failures;
+    }
+    std::printf("%s\n", failures ? "FAILED" : "every channel's counter matches its subscribers");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+// Loading a snapshot whose sections have been tampered with. App does not check
+// section checksums when it is made from a snapshot, so each offset and id that
+// points into another array must be caught by the loaders themselves: every
+// case below patches one value in an otherwise valid file and expects
+// std::runtime_error, not a crash or a read out of bounds.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <App.h>
+#include <Channel.h>
+#include <Snapshot.h>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    int failures = 0;
+
+    std::string readFile(const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+
+    // The bytes of one section inside a whole snapshot file.
+    char* sectionData(std::string& file, SnapshotSection id, size_t& size) {
+        snapshot_format::Header header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        for (uint64_t i = 0; i < header.sectionCount; i++) {
+            snapshot_format::Entry entry;
+            std::memcpy(&entry, file.data() + header.tableOffset + i * sizeof(entry), sizeof(entry));
+            if (entry.id == static_cast<uint32_t>(id)) {
+                size = entry.size;
+                return file.data() + entry.offset;
+            }
+        }
+        throw std::logic_error("section missing from the test snapshot");
+    }
+
+    template<typename T>
+    T get(const char* at) {
+        T value;
+        std::memcpy(&value, at, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void put(char* at, T value) {
+        std::memcpy(at, &value, sizeof(T));
+    }
+
+    void expectRejected(const char* name, const std::string& file, const fs::path& path) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(file.data(), static_cast<std::streamsize>(file.size()));
+        try {
+            const App loaded(std::make_shared<const Snapshot>(path));
+            std::printf("FAIL %s: loaded\n", name);
+            ++failures;
+        } catch (const std::runtime_error&) {
+            std::printf("ok   %s\n", name);
+        }
+    }
+
+    void expectDamaged(const char* name, const std::string& good, const fs::path& path, SnapshotSection id,
+                       const std::function<void(char*, size_t)>& patch) {
+        std::string file = good;
+        size_t size = 0;
+        char* data = sectionData(file, id, size);
+        patch(data, size);
+        expectRejected(name, file, path);
+    }
+
+    // Patches the section table itself and stores its matching checksum, as a
+    // crafted file would, so only the alignment checks stand in the way.
+    void expectBadTable(const char* name, const std::string& good, const fs::path& path,
+                        const std::function<void(std::string&, snapshot_format::Header&)>& patch) {
+        std::string file = good;
+        snapshot_format::Header header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        patch(file, header);
+        header.tableChecksum = snapshot_format::checksum(file.data() + header.tableOffset,
+                                                         header.sectionCount * sizeof(snapshot_format::Entry));
+        std::memcpy(file.data(), &header, sizeof(header));
+        expectRejected(name, file, path);
+    }
+}
+
+int main() {
+    // App says goodbye on std::cout
+    std::cout.setstate(std::ios::failbit);
+    const fs::path directory = fs::temp_directory_path() / "oop_snapshot_damage";
+    fs::create_directories(directory);
+    const fs::path goodPath = directory / "good.snap";
+    const fs::path damagedPath = directory / "damaged.snap";
+
+    constexpr uint32_t user_count = 300;
+    constexpr uint32_t channel_count = 20;
+    {
+        App app;
+        for (uint32_t i = 0; i < user_count; i++)
+            app.addUser(i % 2 ? "user" + std::to_string(i) : "a rather long username, number " + std::to_string(i));
+        for (uint32_t i = 0; i < channel_count; i++)
+            app.addChannel("channel" + std::to_string(i), app.getUser(i));
+        const auto channels = app.getChannels();
+        // more than one skip block's worth of titles share a word
+        for (uint32_t i = 0; i < 200; i++)
+            channels[i % channel_count]->publishVideo("common video " + std::to_string(i));
+        for (uint32_t i = 0; i < user_count; i++)
+            for (uint32_t k = 0; k < 3; k++)
+                app.subscribe(app.getUser(i).getUsername(), (i + k * 7) % channel_count);
+        app.saveSnapshot(goodPath);
+    }
+    const std::string good = readFile(goodPath);
+
+    {
+        const App loaded(std::make_shared<const Snapshot>(goodPath));
+        if (loaded.searchVideos("common").size() != 100 || !loaded.findUser("user1")) {
+            std::printf("FAIL untouched snapshot did not load back\n");
+            ++failures;
+        }
+    }
+
+    constexpr uint32_t huge = 1000000000;
+    expectDamaged("user name offset past the names", good, damagedPath, SnapshotSection::user_name_offsets,
+                  [](char* data, size_t) { put<uint64_t>(data + 8, huge); });
+    // user index slots: hash (8 bytes), value (4), length (4), key or pool offset (16)
+    expectDamaged("user index value past the users", good, damagedPath, SnapshotSection::user_index_slots,
+                  [](char* data, size_t size) {
+                      for (size_t at = 0; at < size; at += 32)
+                          if (get<uint32_t>(data + at + 8) != UINT32_MAX) {
+                              put<uint32_t>(data + at + 8, user_count + 5);
+                              return;
+                          }
+                  });
+    expectDamaged("user index key past the key pool", good, damagedPath, SnapshotSection::user_index_slots,
+                  [](char* data, size_t size) {
+                      for (size_t at = 0; at < size; at += 32)
+                          if (get<uint32_t>(data + at + 8) != UINT32_MAX && get<uint32_t>(data + at + 12) > 16) {
+                              put<uint64_t>(data + at + 16, huge);
+                              return;
+                          }
+                  });
+    expectDamaged("user index with no empty slot", good, damagedPath, SnapshotSection::user_index_meta,
+                  [](char* data, size_t) { put<uint64_t>(data, UINT32_MAX); });
+    expectDamaged("subscription to a missing channel", good, damagedPath, SnapshotSection::subscription_user_targets,
+                  [](char* data, size_t) { put<uint32_t>(data, huge); });
+    expectDamaged("subscriber who is not a user", good, damagedPath, SnapshotSection::subscription_channel_targets,
+                  [](char* data, size_t) { put<uint32_t>(data, huge); });
+    expectDamaged("subscriptions out of order", good, damagedPath, SnapshotSection::subscription_user_targets,
+                  [](char* data, size_t) { put<uint32_t>(data + 4, get<uint32_t>(data)); });
+    expectDamaged("channel owned by a missing user", good, damagedPath, SnapshotSection::channel_owners,
+                  [](char* data, size_t) { put<uint32_t>(data, huge); });
+    expectDamaged("video of a missing channel", good, damagedPath, SnapshotSection::video_docs,
+                  [](char* data, size_t) { put<uint32_t>(data, huge); });
+    expectDamaged("video past its channel's titles", good, damagedPath, SnapshotSection::video_docs,
+                  [](char* data, size_t) { put<uint32_t>(data + 4, huge); });
+    expectDamaged("posting list that runs off its bytes", good, damagedPath, SnapshotSection::title_index_posting_bytes,
+                  [](char* data, size_t size) { std::memset(data, 0xff, size); });
+    expectDamaged("posting past the last document", good, damagedPath, SnapshotSection::title_index_meta,
+                  [](char* data, size_t) { put<uint64_t>(data, 1); });
+    expectDamaged("trie children past the child array", good, damagedPath, SnapshotSection::title_index_child_offsets,
+                  [](char* data, size_t) { put<uint64_t>(data + 8, huge); });
+    // misaligned table and section offsets; the bytes they point at are a valid copy
+    expectBadTable("section table off its alignment", good, damagedPath,
+                   [](std::string& file, snapshot_format::Header& header) {
+                       const std::string table = file.substr(header.tableOffset, header.sectionCount * sizeof(snapshot_format::Entry));
+                       file.push_back('\0');
+                       header.tableOffset = file.size();
+                       file += table;
+                   });
+    expectBadTable("section off its alignment", good, damagedPath,
+                   [](std::string& file, snapshot_format::Header& header) {
+                       snapshot_format::Entry entry;
+                       char* at = file.data() + header.tableOffset;
+                       std::memcpy(&entry, at, sizeof(entry));
+                       const std::string bytes = file.substr(entry.offset, entry.size);
+                       entry.offset = file.size() + 1;
+                       file.push_back('\0');
+                       file += bytes;
+                       std::memcpy(file.data() + header.tableOffset, &entry, sizeof(entry));
+                   });
+
+    fs::remove_all(directory);
+    std::printf("%s\n", failures ? "FAILED" : "every damaged snapshot was rejected");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+// An App served from a mapped snapshot takes writes beside the mapping: new
+// users, names already taken by mapped ones, channels owned by mapped users,
+// videos on mapped channels and subscriptions in both directions. A copy made
+// after the load keeps its own writes, and saving the App merges the mapped
+// state with everything written since, so loading that file gives it all back.
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <App.h>
+#include <Channel.h>
+#include <Snapshot.h>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr uint32_t user_count = 200;
+    constexpr uint32_t channel_count = 10;
+
+    int failures = 0;
+
+    void expect(bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAIL %s\n", what);
+            ++failures;
+        }
+    }
+
+    // Every other name is too long to live inside an index slot.
+    std::string nameOf(uint32_t i) {
+        return i % 2 ? "user" + std::to_string(i) : "a rather long username, number " + std::to_string(i);
+    }
+
+    std::vector<User> makeUsers() {
+        std::vector<User> users;
+        for (uint32_t i = 0; i < user_count; i++) {
+            const PasswordManager::Salt salt = PasswordManager::make_salt();
+            users.emplace_back(PasswordManager::hash_password("secret" + std::to_string(i), salt), nameOf(i), salt);
+        }
+        return users;
+    }
+
+    // What the first App and everything loaded from it must agree on.
+    void expectOriginal(const App& app, const char* what) {
+        bool users = true;
+        for (uint32_t i = 0; i < user_count; i++)
+            users = users && app.findUser(nameOf(i)) && app.getUser(i).getUsername() == nameOf(i);
+        expect(users, what);
+        expect(app.getChannelTable().size() >= channel_count && app.getChannelTable().name(3) == "channel3", what);
+        expect(app.getChannelTable().videoTitle(2, 0) == "first video of 2", what);
+        expect(app.searchVideos("video of 4").size() == 1, what);
+        expect(app.getSubscriptions().isSubscribed(7, 7 % channel_count), what);
+    }
+}
+
+int main() {
+    // App says goodbye on std::cout
+    std::cout.setstate(std::ios::failbit);
+    const fs::path directory = fs::temp_directory_path() / "oop_snapshot_mapped";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    const fs::path first = directory / "first.snap";
+    const fs::path second = directory / "second.snap";
+
+    {
+        App app(makeUsers());
+        for (uint32_t i = 0; i < channel_count; i++)
+            app.addChannel("channel" + std::to_string(i), app.getUser(i));
+        const auto channels = app.getChannels();
+        for (uint32_t i = 0; i < channel_count; i++)
+            channels[i]->publishVideo("first video of " + std::to_string(i));
+        for (uint32_t i = 0; i < user_count; i++)
+            app.subscribe(nameOf(i), i % channel_count);
+        app.saveSnapshot(first);
+    }
+
+    {
+        App app = App::loadSnapshot(first);
+        expectOriginal(app, "mapped state reads back");
+        expect(app.login(nameOf(5), "secret5") && !app.login(nameOf(5), "secret6"), "login against a mapped user");
+
+        app.addUser(nameOf(4));
+        app.addUser("newcomer");
+        app.addUser("a newcomer whose name does not fit a slot");
+        // a taken name would have been stored at user_count
+        expect(app.getUser(user_count).getUsername() == "newcomer", "new users follow the mapped ones");
+        app.addChannel("fresh channel", app.getUser(1));
+        const auto channels = app.getChannels();
+        channels[2]->publishVideo("second video of 2");
+        channels[channel_count]->publishVideo("first video of the fresh channel");
+        expect(app.subscribe("newcomer", 2) && app.subscribe(nameOf(3), channel_count), "subscribe after the load");
+        expect(app.unsubscribe(nameOf(2), 2) && !app.unsubscribe(nameOf(2), 2), "unsubscribe a mapped edge");
+        expect(app.getChannelTable().subscribers(2) == user_count / channel_count, "counters after the load");
+
+        App copy(app);
+        copy.addUser("copy only");
+        copy.getChannels()[2]->publishVideo("copy only video");
+        expect(!app.findUser("copy only") && app.getChannelTable().videos(2) == 2, "copy writes stay in the copy");
+        expect(copy.getChannelTable().videoTitle(2, 2) == "copy only video", "copy sees its own write");
+
+        expect(app.getChannelTable().videoTitle(2, 1) == "second video of 2", "later title on a mapped channel");
+        expect(app.searchVideos("first").size() == channel_count + 1, "search spans mapped and later titles");
+        app.saveSnapshot(second);
+    }
+
+    {
+        App app = App::loadSnapshot(second);
+        expectOriginal(app, "merged snapshot keeps the mapped state");
+        expect(app.findUser("newcomer") && app.findUser("a newcomer whose name does not fit a slot") &&
+               !app.findUser("copy only"), "merged snapshot keeps later users");
+        expect(app.getUser(user_count + 1).getUsername() == "a newcomer whose name does not fit a slot",
+               "later users keep their positions");
+        expect(app.getChannelTable().name(channel_count) == "fresh channel", "later channel");
+        expect(app.getChannelTable().videoTitle(2, 1) == "second video of 2" &&
+               app.getChannelTable().videoTitle(channel_count, 0) == "first video of the fresh channel",
+               "later titles");
+        expect(app.getSubscriptions().isSubscribed(user_count, 2) && !app.getSubscriptions().isSubscribed(2, 2) &&
+               app.getChannelTable().subscribers(2) == user_count / channel_count, "later subscriptions");
+        expect(app.login(nameOf(5), "secret5"), "login after the second load");
+    }
+
+    fs::remove_all(directory);
+    std::printf("%s\n", failures ? "FAILED" : "mapped snapshot takes writes and saves them");
+    return failures ? 1 : 0;
+}
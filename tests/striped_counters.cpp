@@ -0,0 +1,100 @@
+// StripedCounters under contention: 1 to 64 threads subscribe and unsubscribe
+// on one row, two to one, and the final count must be exact; then the same
+// threads unsubscribe far more often than the row was subscribed, and it must
+// end at zero, with exactly the surplus decrements reporting failure. Readers
+// run exact() throughout and must never see a count above the row's bound.
+// Copies share counter blocks, so writes after a copy must stay on their side.
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <StripedCounters.h>
+
+namespace {
+    int failures = 0;
+
+    void expect(bool condition, const char* what, size_t threads) {
+        if (!condition) {
+            std::printf("FAIL %s with %zu threads\n", what, threads);
+            ++failures;
+        }
+    }
+
+    void contend(size_t threads) {
+        constexpr size_t operations = 30000;
+        StripedCounters counters;
+        counters.resize(3);
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> readerMax{0};
+
+        // a reader on the hammered row; the neighbours must stay untouched
+        std::jthread reader([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                const uint64_t seen = counters.exact(1);
+                if (seen > readerMax.load(std::memory_order_relaxed))
+                    readerMax.store(seen, std::memory_order_relaxed);
+            }
+        });
+        {
+            std::vector<std::jthread> workers;
+            for (size_t t = 0; t < threads; t++)
+                workers.emplace_back([&] {
+                    for (size_t i = 0; i < operations; i++) {
+                        if (i % 3 == 2)
+                            counters.decrement(1);
+                        else
+                            counters.increment(1);
+                    }
+                });
+        }
+        const uint64_t subscribed = threads * (operations - operations / 3 - operations / 3);
+        expect(counters.exact(1) == subscribed, "subscribe/unsubscribe mix", threads);
+        expect(counters.exact(0) == 0 && counters.exact(2) == 0, "neighbouring rows", threads);
+
+        // over-drain: every thread takes twice its share of what is left
+        std::atomic<uint64_t> taken{0};
+        const size_t perThread = 2 * (subscribed / threads + 1);
+        {
+            std::vector<std::jthread> workers;
+            for (size_t t = 0; t < threads; t++)
+                workers.emplace_back([&] {
+                    for (size_t i = 0; i < perThread; i++)
+                        if (counters.decrement(1))
+                            taken.fetch_add(1, std::memory_order_relaxed);
+                });
+        }
+        stop.store(true, std::memory_order_relaxed);
+        reader.join();
+        expect(counters.exact(1) == 0, "clamped at zero after over-drain", threads);
+        expect(taken.load() == subscribed, "successful decrements match the count", threads);
+        expect(!counters.decrement(1), "decrement of an empty row", threads);
+        expect(readerMax.load() <= threads * (operations - operations / 3), "exact() within bounds", threads);
+    }
+
+    // A copy shares the counter blocks; a write on either side after it must not show through.
+    void copies() {
+        StripedCounters original;
+        original.resize(100);
+        for (size_t row = 0; row < 100; row++)
+            original.assign(row, row);
+        StripedCounters copy = original;
+        original.increment(5);
+        copy.decrement(50);
+        copy.increment(99);
+        bool same = true;
+        for (size_t row = 0; row < 100; row++) {
+            same = same && original.exact(row) == row + (row == 5);
+            same = same && copy.exact(row) == row - (row == 50) + (row == 99);
+        }
+        expect(same, "writes after a copy stay on their side", 1);
+    }
+}
+
+int main() {
+    copies();
+    for (size_t threads = 1; threads <= 64; threads *= 2)
+        contend(threads);
+    std::printf("%s\n", failures ? "FAILED" : "striped counters exact under contention");
+    return failures ? 1 : 0;
+}